@@ -1,13 +1,17 @@
+#define _POSIX_C_SOURCE 200809L   // strdup, getline
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#define NO_BLOCK -1                                 // Block slot that refers to no block
+#define SEARCH_MEMORY_LIMIT ((size_t)256 << 20)     // Bytes of states the A* planner may store
 
-#define MAX_BLOCKS 10
-#define MAX_STACK_SIZE 100
-#define MAX_STRING_LEN 50
-#define MAX_STACKS 10
-#define MAX_OPERATIONS 50
+typedef uint64_t BlockWord;                         // Bitsets over block IDs, 64 blocks per word
 
 // Condition types
 typedef enum {
@@ -21,8 +25,8 @@ typedef enum {
 // Structure for a condition
 typedef struct {
     ConditionType type;
-    char block1;
-    char block2;  // Used only for ON condition
+    int block1;
+    int block2;  // Used only for ON condition
 } Condition;
 
 // Structure for an operation
@@ -35,14 +39,17 @@ typedef enum {
 
 typedef struct {
     OperationType type;
-    char block1;
-    char block2;  // Used only for STACK and UNSTACK
+    int block1;
+    int block2;  // Used only for STACK and UNSTACK
 } Operation;
 
 // Structure to store operation history
 typedef struct {
-    Operation operations[MAX_OPERATIONS];
+    Operation *operations;  // Grows as operations are added
     int count;
+    int capacity;
+    int completed;          // The planner reached the goal state
+    double seconds;         // CPU time the planner took
 } OperationHistory;
 
 // Stack element types
@@ -62,28 +69,198 @@ typedef struct {
     } element;
 } StackElement;
 
-// World state represented as a list of conditions
+// World state: a set of conditions stored so that every test and update
+// is a bit operation or an array lookup. A goal state uses the same layout
+// and holds only the conditions that have to become true. The arrays have
+// one entry per block and are allocated by initWorldState.
 typedef struct {
-    Condition conditions[MAX_BLOCKS * 3]; // Max possible conditions
-    int count;
+    int *on;                // ON(x, on[x]) holds, NO_BLOCK when there is no ON(x, _)
+    int *above;             // ON(above[y], y) holds, NO_BLOCK when nothing is on y
+    BlockWord *onTable;     // ONTABLE(x) holds
+    int *tableRank;         // When ONTABLE(x) was added; stacks are listed in this order
+    int tableClock;
+    BlockWord *clear;       // CLEAR(x) holds
+    int holding;            // HOLDING(holding) holds, NO_BLOCK when no block is held
+    int armEmpty;           // ARMEMPTY holds
 } WorldState;
 
+// Blocks get IDs 0..numBlocks-1 in order of first appearance, and are
+// renumbered in name order once the input is read. Their names are found
+// through an open-addressing table of IDs.
+int numBlocks = 0;          // Declared number of blocks; sizes every state
+int namedBlocks = 0;        // Blocks named so far
+int blockWords = 0;         // BlockWords in each bitset
+char **blockNames = NULL;
+int *nameIndex = NULL;      // Block ID in each slot, NO_BLOCK when empty
+int nameIndexSize = 0;
+
 // Goal stack
-StackElement goalStack[MAX_STACK_SIZE];
+StackElement *goalStack = NULL;
 int stackTop = -1;
+int stackCapacity = 0;
+int stackPeak = 0;          // Deepest the goal stack got in the current run
+
+// Trace every planning step; --quiet leaves only the results
+int verbose = 1;
 
 // Operation histories
 OperationHistory topToBottomHistory = {0};
 OperationHistory bottomToTopHistory = {0};
+OperationHistory optimalHistory = {0};
+long optimalExpanded = 0;       // States the A* planner expanded
+long optimalGenerated = 0;      // Distinct states it generated
+int topToBottomPeak = 0;        // Goal stack depth reached by each goal-stack planner
+int bottomToTopPeak = 0;
 OperationHistory *currentHistory = NULL;
 
+static inline int testBit(BlockWord *set, int block) {
+    return (set[block >> 6] >> (block & 63)) & 1;
+}
+
+static inline void setBit(BlockWord *set, int block) {
+    set[block >> 6] |= (BlockWord)1 << (block & 63);
+}
+
+static inline void resetBit(BlockWord *set, int block) {
+    set[block >> 6] &= ~((BlockWord)1 << (block & 63));
+}
+
+// Function to size the block tables for 'count' blocks
+void initBlocks(int count) {
+    numBlocks = count;
+    namedBlocks = 0;
+    blockWords = (count + 63) / 64;
+    blockNames = calloc(count, sizeof(char *));
+    nameIndexSize = 16;
+    while (nameIndexSize < 2 * count) {
+        nameIndexSize *= 2;
+    }
+    nameIndex = malloc(nameIndexSize * sizeof(int));
+    for (int i = 0; i < nameIndexSize; i++) {
+        nameIndex[i] = NO_BLOCK;
+    }
+}
+
+unsigned int hashName(const char *name) {
+    // FNV-1a
+    unsigned int hash = 2166136261u;
+    for (; *name; name++) {
+        hash = (hash ^ (unsigned char)*name) * 16777619u;
+    }
+    return hash;
+}
+
+// Function to get the ID of a block by name, giving new names the next
+// ID. Returns NO_BLOCK once more than numBlocks names have been used.
+int internBlock(const char *name) {
+    unsigned int slot = hashName(name) & (nameIndexSize - 1);
+    while (nameIndex[slot] != NO_BLOCK) {
+        if (strcmp(blockNames[nameIndex[slot]], name) == 0) {
+            return nameIndex[slot];
+        }
+        slot = (slot + 1) & (nameIndexSize - 1);
+    }
+    if (namedBlocks == numBlocks) {
+        return NO_BLOCK;
+    }
+    blockNames[namedBlocks] = strdup(name);
+    nameIndex[slot] = namedBlocks;
+    return namedBlocks++;
+}
+
+// Function to allocate an empty world state for numBlocks blocks
+void initWorldState(WorldState *state) {
+    state->on = malloc(numBlocks * sizeof(int));
+    state->above = malloc(numBlocks * sizeof(int));
+    state->tableRank = calloc(numBlocks, sizeof(int));
+    state->onTable = calloc(blockWords, sizeof(BlockWord));
+    state->clear = calloc(blockWords, sizeof(BlockWord));
+    for (int b = 0; b < numBlocks; b++) {
+        state->on[b] = NO_BLOCK;
+        state->above[b] = NO_BLOCK;
+    }
+    state->tableClock = 0;
+    state->holding = NO_BLOCK;
+    state->armEmpty = 0;
+}
+
+void freeWorldState(WorldState *state) {
+    free(state->on);
+    free(state->above);
+    free(state->tableRank);
+    free(state->onTable);
+    free(state->clear);
+}
+
+int compareBlockNames(const void *a, const void *b) {
+    return strcmp(blockNames[*(const int *)a], blockNames[*(const int *)b]);
+}
+
+// Function to move the blocks of a state to the IDs in 'newId'
+void renumberWorldState(WorldState *state, int *newId) {
+    WorldState renumbered;
+    initWorldState(&renumbered);
+    for (int b = 0; b < numBlocks; b++) {
+        int id = newId[b];
+        renumbered.on[id] = state->on[b] == NO_BLOCK ? NO_BLOCK : newId[state->on[b]];
+        renumbered.above[id] = state->above[b] == NO_BLOCK ? NO_BLOCK : newId[state->above[b]];
+        renumbered.tableRank[id] = state->tableRank[b];
+        if (testBit(state->onTable, b)) {
+            setBit(renumbered.onTable, id);
+        }
+        if (testBit(state->clear, b)) {
+            setBit(renumbered.clear, id);
+        }
+    }
+    renumbered.tableClock = state->tableClock;
+    renumbered.holding = state->holding == NO_BLOCK ? NO_BLOCK : newId[state->holding];
+    renumbered.armEmpty = state->armEmpty;
+    freeWorldState(state);
+    *state = renumbered;
+}
+
+// Function to give the named blocks IDs in name order, so that the planners
+// break ties the same way whatever order the stacks were entered in
+void sortBlocksByName(WorldState *initialState, WorldState *goalState) {
+    int *order = malloc(numBlocks * sizeof(int));
+    int *newId = malloc(numBlocks * sizeof(int));
+    char **names = malloc(numBlocks * sizeof(char *));
+    for (int b = 0; b < numBlocks; b++) {
+        order[b] = b;
+    }
+    qsort(order, namedBlocks, sizeof(int), compareBlockNames);
+    for (int i = 0; i < numBlocks; i++) {
+        newId[order[i]] = i;
+        names[i] = blockNames[order[i]];
+    }
+    
+    renumberWorldState(initialState, newId);
+    renumberWorldState(goalState, newId);
+    for (int i = 0; i < nameIndexSize; i++) {
+        if (nameIndex[i] != NO_BLOCK) {
+            nameIndex[i] = newId[nameIndex[i]];
+        }
+    }
+    free(blockNames);
+    blockNames = names;
+    free(order);
+    free(newId);
+}
+
 // Function to push an element to the goal stack
 void push(StackElement element) {
-    if (stackTop >= MAX_STACK_SIZE - 1) {
-        printf("Error: Stack overflow\n");
-        exit(1);
+    if (stackTop + 1 == stackCapacity) {
+        stackCapacity = stackCapacity > 0 ? stackCapacity * 2 : 256;
+        goalStack = realloc(goalStack, stackCapacity * sizeof(StackElement));
+        if (goalStack == NULL) {
+            printf("Error: Out of memory for the goal stack\n");
+            exit(1);
+        }
     }
     goalStack[++stackTop] = element;
+    if (stackTop + 1 > stackPeak) {
+        stackPeak = stackTop + 1;
+    }
 }
 
 // Function to pop an element from the goal stack
@@ -99,16 +276,16 @@ StackElement pop() {
 void printCondition(Condition c) {
     switch (c.type) {
         case ONTABLE:
-            printf("ONTABLE(%c)", c.block1);
+            printf("ONTABLE(%s)", blockNames[c.block1]);
             break;
         case ON:
-            printf("ON(%c,%c)", c.block1, c.block2);
+            printf("ON(%s,%s)", blockNames[c.block1], blockNames[c.block2]);
             break;
         case CLEAR:
-            printf("CLEAR(%c)", c.block1);
+            printf("CLEAR(%s)", blockNames[c.block1]);
             break;
         case HOLDING:
-            printf("HOLDING(%c)", c.block1);
+            printf("HOLDING(%s)", blockNames[c.block1]);
             break;
         case ARMEMPTY:
             printf("ARMEMPTY");
@@ -120,29 +297,42 @@ void printCondition(Condition c) {
 void printOperation(Operation op) {
     switch (op.type) {
         case STACK:
-            printf("STACK(%c,%c)", op.block1, op.block2);
+            printf("STACK(%s,%s)", blockNames[op.block1], blockNames[op.block2]);
             break;
         case UNSTACK:
-            printf("UNSTACK(%c,%c)", op.block1, op.block2);
+            printf("UNSTACK(%s,%s)", blockNames[op.block1], blockNames[op.block2]);
             break;
         case PICKUP:
-            printf("PICKUP(%c)", op.block1);
+            printf("PICKUP(%s)", blockNames[op.block1]);
             break;
         case PUTDOWN:
-            printf("PUTDOWN(%c)", op.block1);
+            printf("PUTDOWN(%s)", blockNames[op.block1]);
             break;
     }
 }
 
 // Function to add operation to history
 void addToHistory(Operation op) {
-    if (currentHistory != NULL && currentHistory->count < MAX_OPERATIONS) {
-        currentHistory->operations[currentHistory->count++] = op;
+    if (currentHistory == NULL) {
+        return;
+    }
+    if (currentHistory->count == currentHistory->capacity) {
+        currentHistory->capacity = currentHistory->capacity > 0 ? currentHistory->capacity * 2 : 64;
+        currentHistory->operations = realloc(currentHistory->operations,
+                                             currentHistory->capacity * sizeof(Operation));
+        if (currentHistory->operations == NULL) {
+            printf("Error: Out of memory for the operation history\n");
+            exit(1);
+        }
     }
+    currentHistory->operations[currentHistory->count++] = op;
 }
 
 // Function to print the goal stack
 void printStack() {
+    if (!verbose) {
+        return;
+    }
     printf("\nGoal Stack (from top to bottom):\n");
     for (int i = stackTop; i >= 0; i--) {
         if (goalStack[i].type == GOAL) {
@@ -161,123 +351,150 @@ void printStack() {
 
 // Function to check if a condition is in the world state
 int conditionExists(WorldState *state, Condition c) {
-    for (int i = 0; i < state->count; i++) {
-        Condition current = state->conditions[i];
-        
-        if (current.type != c.type) continue;
-        
-        switch (c.type) {
-            case ONTABLE:
-            case CLEAR:
-            case HOLDING:
-                if (current.block1 == c.block1) return 1;
-                break;
-            case ON:
-                if (current.block1 == c.block1 && current.block2 == c.block2) return 1;
-                break;
-            case ARMEMPTY:
-                return 1;
-                break;
-        }
+    switch (c.type) {
+        case ONTABLE:
+            return testBit(state->onTable, c.block1);
+        case ON:
+            return state->on[c.block1] == c.block2;
+        case CLEAR:
+            return testBit(state->clear, c.block1);
+        case HOLDING:
+            return state->holding == c.block1;
+        case ARMEMPTY:
+            return state->armEmpty;
     }
     return 0;
 }
 
 // Function to add a condition to the world state
 void addCondition(WorldState *state, Condition c) {
-    if (!conditionExists(state, c)) {
-        state->conditions[state->count++] = c;
+    switch (c.type) {
+        case ONTABLE:
+            if (!testBit(state->onTable, c.block1)) {
+                setBit(state->onTable, c.block1);
+                state->tableRank[c.block1] = ++state->tableClock;
+            }
+            break;
+        case ON:
+            state->on[c.block1] = c.block2;
+            state->above[c.block2] = c.block1;
+            break;
+        case CLEAR:
+            setBit(state->clear, c.block1);
+            break;
+        case HOLDING:
+            state->holding = c.block1;
+            break;
+        case ARMEMPTY:
+            state->armEmpty = 1;
+            break;
     }
 }
 
 // Function to remove a condition from the world state
 void removeCondition(WorldState *state, Condition c) {
-    for (int i = 0; i < state->count; i++) {
-        Condition current = state->conditions[i];
-        
-        if (current.type != c.type) continue;
-        
-        int match = 0;
-        switch (c.type) {
-            case ONTABLE:
-            case CLEAR:
-            case HOLDING:
-                match = (current.block1 == c.block1);
-                break;
-            case ON:
-                match = (current.block1 == c.block1 && current.block2 == c.block2);
-                break;
-            case ARMEMPTY:
-                match = 1;
-                break;
-        }
-        
-        if (match) {
-            // Remove by shifting all elements down
-            for (int j = i; j < state->count - 1; j++) {
-                state->conditions[j] = state->conditions[j + 1];
-            }
-            state->count--;
-            return;
+    if (!conditionExists(state, c)) {
+        return;
+    }
+    switch (c.type) {
+        case ONTABLE:
+            resetBit(state->onTable, c.block1);
+            break;
+        case ON:
+            state->on[c.block1] = NO_BLOCK;
+            state->above[c.block2] = NO_BLOCK;
+            break;
+        case CLEAR:
+            resetBit(state->clear, c.block1);
+            break;
+        case HOLDING:
+            state->holding = NO_BLOCK;
+            break;
+        case ARMEMPTY:
+            state->armEmpty = 0;
+            break;
+    }
+}
+
+typedef struct {
+    int rank;
+    int block;
+} RankedBlock;
+
+int compareRanks(const void *a, const void *b) {
+    return ((const RankedBlock *)a)->rank - ((const RankedBlock *)b)->rank;
+}
+
+// Function to find the blocks on the table in the order they were put there
+int tableBlocksInOrder(WorldState *state, int *blocks) {
+    RankedBlock *ranked = malloc((numBlocks > 0 ? numBlocks : 1) * sizeof(RankedBlock));
+    int count = 0;
+    for (int b = 0; b < numBlocks; b++) {
+        if (testBit(state->onTable, b)) {
+            ranked[count].rank = state->tableRank[b];
+            ranked[count].block = b;
+            count++;
         }
     }
+    qsort(ranked, count, sizeof(RankedBlock), compareRanks);
+    for (int i = 0; i < count; i++) {
+        blocks[i] = ranked[i].block;
+    }
+    free(ranked);
+    return count;
 }
 
-// Function to update the world state based on an operation
-void executeOperation(WorldState *state, Operation op) {
-    Condition c;
-    
-    printf("Executing: ");
-    printOperation(op);
-    printf("\n");
-    
-     // Check if trying to pick up a block while already holding another
-     if ((op.type == PICKUP || op.type == UNSTACK) && !conditionExists(state, (Condition){.type = ARMEMPTY})) {
-        // Find what block is being held
-        char heldBlock = '\0';
-        for (int i = 0; i < state->count; i++) {
-            if (state->conditions[i].type == HOLDING) {
-                heldBlock = state->conditions[i].block1;
-                break;
-            }
+// Function to list the conditions of a world state: stack by stack from
+// the table up (ONTABLE, ON..., CLEAR of the top), then the arm. This is
+// also the order in which the planners push the goal conditions. The
+// array needs room for 3 * numBlocks + 1 conditions.
+int listConditions(WorldState *state, Condition *conditions) {
+    int *tableBlocks = malloc((numBlocks > 0 ? numBlocks : 1) * sizeof(int));
+    char *listed = calloc(numBlocks > 0 ? numBlocks : 1, 1);
+    int tableBlockCount = tableBlocksInOrder(state, tableBlocks);
+    int count = 0;
+    for (int i = 0; i < tableBlockCount; i++) {
+        int block = tableBlocks[i];
+        conditions[count++] = (Condition){.type = ONTABLE, .block1 = block};
+        listed[block] = 1;
+        while (state->above[block] != NO_BLOCK && !listed[state->above[block]]) {
+            int upper = state->above[block];
+            conditions[count++] = (Condition){.type = ON, .block1 = upper, .block2 = block};
+            listed[upper] = 1;
+            block = upper;
         }
-        
-        if (heldBlock != '\0') {
-            printf("WARNING: Arm is already holding block %c. Putting it down first.\n", heldBlock);
-            
-            // Create and execute a PUTDOWN operation for the held block
-            Operation putdownOp = {.type = PUTDOWN, .block1 = heldBlock};
-            
-            // Remove HOLDING condition
-            c.type = HOLDING;
-            c.block1 = heldBlock;
-            removeCondition(state, c);
-            
-            // Add ARMEMPTY, ONTABLE and CLEAR conditions
-            c.type = ARMEMPTY;
-            addCondition(state, c);
-            
-            c.type = ONTABLE;
-            c.block1 = heldBlock;
-            addCondition(state, c);
-            
-            c.type = CLEAR;
-            c.block1 = heldBlock;
-            addCondition(state, c);
-            
-            // Add putdown to history as well
-            addToHistory(putdownOp);
-            
-            printf("Automatically executed: PUTDOWN(%c)\n", heldBlock);
+        if (testBit(state->clear, block)) {
+            conditions[count++] = (Condition){.type = CLEAR, .block1 = block};
+        }
+    }
+    // Blocks that are not in a stack standing on the table
+    for (int b = 0; b < numBlocks; b++) {
+        if (listed[b]) {
+            continue;
+        }
+        if (state->on[b] != NO_BLOCK) {
+            conditions[count++] = (Condition){.type = ON, .block1 = b, .block2 = state->on[b]};
         }
+        if (testBit(state->clear, b)) {
+            conditions[count++] = (Condition){.type = CLEAR, .block1 = b};
+        }
+    }
+    if (state->holding != NO_BLOCK) {
+        conditions[count++] = (Condition){.type = HOLDING, .block1 = state->holding};
     }
+    if (state->armEmpty) {
+        conditions[count++] = (Condition){.type = ARMEMPTY};
+    }
+    free(tableBlocks);
+    free(listed);
+    return count;
+}
 
-    // Add to operation history
-    addToHistory(op);
-    
-   
+// Function to apply the effects of an operation to the world state without
+// printing or recording it (the planners' search uses this directly)
+void applyOperation(WorldState *state, Operation op) {
+    Condition c;
     
-    // Now proceed with the original operation
     switch (op.type) {
         case STACK:
             // Remove preconditions
@@ -367,80 +584,142 @@ void executeOperation(WorldState *state, Operation op) {
     }
 }
 
+// Function to check the preconditions of an operation. ARMEMPTY is left
+// out for PICKUP and UNSTACK: executeOperation puts a held block down first.
+int preconditionsHold(WorldState *state, Operation op) {
+    switch (op.type) {
+        case STACK:
+            return state->holding == op.block1 && testBit(state->clear, op.block2);
+        case UNSTACK:
+            return state->on[op.block1] == op.block2 && testBit(state->clear, op.block1);
+        case PICKUP:
+            return testBit(state->onTable, op.block1) && testBit(state->clear, op.block1);
+        case PUTDOWN:
+            return state->holding == op.block1;
+    }
+    return 0;
+}
+
+// Function to update the world state based on an operation. Returns 0,
+// leaving the state and the history alone, if the preconditions of the
+// operation do not hold.
+int executeOperation(WorldState *state, Operation op) {
+    if (!preconditionsHold(state, op)) {
+        if (verbose) {
+            printf("Preconditions of ");
+            printOperation(op);
+            printf(" no longer hold.\n");
+        }
+        return 0;
+    }
+    if (verbose) {
+        printf("Executing: ");
+        printOperation(op);
+        printf("\n");
+    }
+    
+     // Check if trying to pick up a block while already holding another
+     if ((op.type == PICKUP || op.type == UNSTACK) && state->holding != NO_BLOCK) {
+        int heldBlock = state->holding;
+        
+        if (heldBlock != NO_BLOCK) {
+            if (verbose) {
+                printf("WARNING: Arm is already holding block %s. Putting it down first.\n", blockNames[heldBlock]);
+            }
+            
+            // Create and execute a PUTDOWN operation for the held block
+            Operation putdownOp = {.type = PUTDOWN, .block1 = heldBlock};
+            applyOperation(state, putdownOp);
+            
+            // Add putdown to history as well
+            addToHistory(putdownOp);
+            
+            if (verbose) {
+                printf("Automatically executed: PUTDOWN(%s)\n", blockNames[heldBlock]);
+            }
+        }
+    }
+
+    // Add to operation history
+    addToHistory(op);
+    
+    // Now proceed with the original operation
+    applyOperation(state, op);
+    return 1;
+}
+
 // Function to print the world state
 void printWorldState(WorldState state) {
+    if (!verbose) {
+        return;
+    }
+    Condition *conditions = malloc((3 * numBlocks + 1) * sizeof(Condition));
+    int count = listConditions(&state, conditions);
+    
     printf("Current World State:\n");
-    for (int i = 0; i < state.count; i++) {
-        printCondition(state.conditions[i]);
+    for (int i = 0; i < count; i++) {
+        printCondition(conditions[i]);
         printf("\n");
     }
     printf("\n");
+    free(conditions);
 }
 
-// Function to parse a stack string and add conditions to the world state
-void parseStack(WorldState *state, char *str) {
-    char buffer[MAX_STRING_LEN];
-    strncpy(buffer, str, MAX_STRING_LEN);
-    
-    // Remove trailing newline if present
-    buffer[strcspn(buffer, "\n")] = 0;
-    
+// Function to parse a stack string and add conditions to the world state.
+// Block names are separated by spaces or commas and are not case-sensitive.
+// Returns 0 if the line names more blocks than were declared, or a block
+// already placed in this state.
+int parseStack(WorldState *state, char *str) {
     // Convert to uppercase
-    for (int i = 0; buffer[i]; i++) {
-        buffer[i] = toupper(buffer[i]);
+    for (int i = 0; str[i]; i++) {
+        str[i] = toupper((unsigned char)str[i]);
     }
     
-    // Count number of blocks in this stack
-    int length = strlen(buffer);
-    int blockCount = 0;
-    for (int i = 0; i < length; i++) {
-        if (isalpha(buffer[i])) {
-            blockCount++;
+    // Process the stack from bottom to top: the bottom block is on the
+    // table and every other block is on the one before it
+    Condition c;
+    int below = NO_BLOCK;
+    for (char *name = strtok(str, " \t\r\n,"); name != NULL; name = strtok(NULL, " \t\r\n,")) {
+        int block = internBlock(name);
+        if (block == NO_BLOCK) {
+            printf("Error: Block %s would exceed the %d blocks declared.\n", name, numBlocks);
+            return 0;
         }
-    }
-    
-    if (blockCount == 0) {
-        return; // Empty stack
-    }
-    
-    // Process the stack from bottom to top
-    char blocks[MAX_BLOCKS];
-    int blockIndex = 0;
-    
-    for (int i = 0; i < length; i++) {
-        if (isalpha(buffer[i])) {
-            blocks[blockIndex++] = buffer[i];
+        if (testBit(state->onTable, block) || state->on[block] != NO_BLOCK) {
+            printf("Error: Block %s appears more than once in the same state.\n", name);
+            return 0;
         }
+        if (below == NO_BLOCK) {
+            c.type = ONTABLE;
+        } else {
+            c.type = ON;
+            c.block2 = below;
+        }
+        c.block1 = block;
+        addCondition(state, c);
+        below = block;
     }
     
-    // Bottom block is on table
-    Condition c;
-    c.type = ONTABLE;
-    c.block1 = blocks[0];
-    addCondition(state, c);
-    
-    // Remaining blocks are stacked on each other
-    for (int i = 1; i < blockCount; i++) {
-        c.type = ON;
-        c.block1 = blocks[i];
-        c.block2 = blocks[i-1];
-        addCondition(state, c);
+    if (below == NO_BLOCK) {
+        return 1; // Empty stack
     }
     
     // Top block is clear
     c.type = CLEAR;
-    c.block1 = blocks[blockCount-1];
+    c.block1 = below;
     addCondition(state, c);
+    return 1;
 }
 
 // Function to add the preconditions of an operation to the stack
 void addPreconditions(Operation op) {
     StackElement element;
-    Condition c;
     
-    printf("Replacing operation with preconditions: ");
-    printOperation(op);
-    printf("\n");
+    if (verbose) {
+        printf("Replacing operation with preconditions: ");
+        printOperation(op);
+        printf("\n");
+    }
     
     switch (op.type) {
         case STACK:
@@ -501,16 +780,21 @@ void addPreconditions(Operation op) {
     }
 }
 
-// Function to achieve a goal (condition)
-void achieveGoal(WorldState *state, Condition goal) {
-    printf("Trying to achieve goal: ");
-    printCondition(goal);
-    printf("\n");
+// Function to achieve a goal (condition). Returns 0 if no operation can
+// achieve it from the current state.
+int achieveGoal(WorldState *state, Condition goal) {
+    if (verbose) {
+        printf("Trying to achieve goal: ");
+        printCondition(goal);
+        printf("\n");
+    }
     
     // Check if the goal is already satisfied
     if (conditionExists(state, goal)) {
-        printf("Goal already satisfied.\n");
-        return;
+        if (verbose) {
+            printf("Goal already satisfied.\n");
+        }
+        return 1;
     }
     
     StackElement element;
@@ -548,134 +832,108 @@ void achieveGoal(WorldState *state, Condition goal) {
             
         case CLEAR:
             // To achieve CLEAR(x), find what's on x and remove it
-            for (int i = 0; i < state->count; i++) {
-                if (state->conditions[i].type == ON && state->conditions[i].block2 == goal.block1) {
-                    char blockOnTop = state->conditions[i].block1;
-                    
-                    // Use UNSTACK to clear the block
-                    op.type = UNSTACK;
-                    op.block1 = blockOnTop;
-                    op.block2 = goal.block1;
-                    
-                    element.type = ACTION;
-                    element.element.operation = op;
-                    push(element);
-                    printStack();
-                    
-                    addPreconditions(op);
-                    printStack();
-                    return;
-                }
+            if (state->above[goal.block1] != NO_BLOCK) {
+                int blockOnTop = state->above[goal.block1];
+                
+                // Use UNSTACK to clear the block
+                op.type = UNSTACK;
+                op.block1 = blockOnTop;
+                op.block2 = goal.block1;
+                
+                element.type = ACTION;
+                element.element.operation = op;
+                push(element);
+                printStack();
+                
+                addPreconditions(op);
+                printStack();
+                return 1;
             }
-            printf("Error: Cannot clear block %c as nothing is on it\n", goal.block1);
-            break;
+            printf("Error: Cannot clear block %s as nothing is on it\n", blockNames[goal.block1]);
+            return 0;
             
         case HOLDING:
             // To achieve HOLDING(x), use PICKUP or UNSTACK depending on where x is
-            for (int i = 0; i < state->count; i++) {
-                if (state->conditions[i].type == ONTABLE && state->conditions[i].block1 == goal.block1) {
-                    // Block is on table, use PICKUP
-                    op.type = PICKUP;
-                    op.block1 = goal.block1;
-                    
-                    element.type = ACTION;
-                    element.element.operation = op;
-                    push(element);
-                    printStack();
-                    
-                    addPreconditions(op);
-                    printStack();
-                    return;
-                } else if (state->conditions[i].type == ON && state->conditions[i].block1 == goal.block1) {
-                    // Block is on another block, use UNSTACK
-                    op.type = UNSTACK;
-                    op.block1 = goal.block1;
-                    op.block2 = state->conditions[i].block2;
-                    
-                    element.type = ACTION;
-                    element.element.operation = op;
-                    push(element);
-                    printStack();
-                    
-                    addPreconditions(op);
-                    printStack();
-                    return;
-                }
+            if (testBit(state->onTable, goal.block1)) {
+                // Block is on table, use PICKUP
+                op.type = PICKUP;
+                op.block1 = goal.block1;
+                
+                element.type = ACTION;
+                element.element.operation = op;
+                push(element);
+                printStack();
+                
+                addPreconditions(op);
+                printStack();
+                return 1;
+            } else if (state->on[goal.block1] != NO_BLOCK) {
+                // Block is on another block, use UNSTACK
+                op.type = UNSTACK;
+                op.block1 = goal.block1;
+                op.block2 = state->on[goal.block1];
+                
+                element.type = ACTION;
+                element.element.operation = op;
+                push(element);
+                printStack();
+                
+                addPreconditions(op);
+                printStack();
+                return 1;
             }
-            printf("Error: Cannot find block %c to hold\n", goal.block1);
-            break;
+            printf("Error: Cannot find block %s to hold\n", blockNames[goal.block1]);
+            return 0;
             
         case ARMEMPTY:
             // To achieve ARMEMPTY, find what the arm is holding and put it down
-            for (int i = 0; i < state->count; i++) {
-                if (state->conditions[i].type == HOLDING) {
-                    char blockHeld = state->conditions[i].block1;
-                    
-                    // Use PUTDOWN to achieve ARMEMPTY
-                    op.type = PUTDOWN;
-                    op.block1 = blockHeld;
-                    
-                    element.type = ACTION;
-                    element.element.operation = op;
-                    push(element);
-                    printStack();
-                    
-                    addPreconditions(op);
-                    printStack();
-                    return;
-                }
+            if (state->holding != NO_BLOCK) {
+                int blockHeld = state->holding;
+                
+                // Use PUTDOWN to achieve ARMEMPTY
+                op.type = PUTDOWN;
+                op.block1 = blockHeld;
+                
+                element.type = ACTION;
+                element.element.operation = op;
+                push(element);
+                printStack();
+                
+                addPreconditions(op);
+                printStack();
+                return 1;
             }
             printf("Error: Arm is already empty\n");
-            break;
+            return 0;
     }
+    return 1;
 }
 
 // Function to visualize the stacks
 void visualizeStacks(WorldState state) {
-    // Find all blocks that are on the table
-    char tableBlocks[MAX_BLOCKS];
-    int tableBlockCount = 0;
-    
-    for (int i = 0; i < state.count; i++) {
-        if (state.conditions[i].type == ONTABLE) {
-            tableBlocks[tableBlockCount++] = state.conditions[i].block1;
-        }
+    if (!verbose) {
+        return;
     }
-    
     printf("Stack Visualization:\n");
     
-    // For each block on the table, build and print its stack
+    int *tableBlocks = malloc((numBlocks > 0 ? numBlocks : 1) * sizeof(int));
+    int tableBlockCount = tableBlocksInOrder(&state, tableBlocks);
+    
+    // For each block on the table, follow the chain of blocks above it
     for (int i = 0; i < tableBlockCount; i++) {
-        char stack[MAX_BLOCKS];
-        int stackSize = 0;
-        
-        // Add the bottom block (on table)
-        stack[stackSize++] = tableBlocks[i];
-        
-        // Find blocks on top recursively
-        char currentTop = tableBlocks[i];
-        while (1) {
-            int found = 0;
-            for (int j = 0; j < state.count; j++) {
-                if (state.conditions[j].type == ON && state.conditions[j].block2 == currentTop) {
-                    currentTop = state.conditions[j].block1;
-                    stack[stackSize++] = currentTop;
-                    found = 1;
-                    break;
-                }
-            }
-            if (!found) break;
-        }
+        int block = tableBlocks[i];
+        int height = 1;
         
         // Print this stack from bottom to top
-        printf("Stack %d: ", i + 1);
-        for (int j = 0; j < stackSize; j++) {
-            printf("%c", stack[j]);
-            if (j < stackSize - 1) printf(" ");
+        printf("Stack %d: %s", i + 1, blockNames[block]);
+        while (state.above[block] != NO_BLOCK && height++ < numBlocks) {
+            block = state.above[block];
+            printf(" %s", blockNames[block]);
         }
         printf("\n");
     }
     printf("\n");
+    free(tableBlocks);
 }
 
 // Function to print operation history
@@ -698,39 +956,119 @@ void printOperationHistory(OperationHistory history, const char* title) {
 // Function to reset the goal stack
 void resetGoalStack() {
     stackTop = -1;
+    stackPeak = 0;
 }
 
-// Function to copy a world state
+// Function to copy a world state into one made by initWorldState
 void copyWorldState(WorldState *dest, WorldState *src) {
-    dest->count = 0;
-    for (int i = 0; i < src->count; i++) {
-        addCondition(dest, src->conditions[i]);
-    }
+    memcpy(dest->on, src->on, numBlocks * sizeof(int));
+    memcpy(dest->above, src->above, numBlocks * sizeof(int));
+    memcpy(dest->tableRank, src->tableRank, numBlocks * sizeof(int));
+    memcpy(dest->onTable, src->onTable, blockWords * sizeof(BlockWord));
+    memcpy(dest->clear, src->clear, blockWords * sizeof(BlockWord));
+    dest->tableClock = src->tableClock;
+    dest->holding = src->holding;
+    dest->armEmpty = src->armEmpty;
 }
 
 // Function to check if current state matches the goal state
 int matchesGoalState(WorldState *currentState, WorldState *goalState) {
-    // Check if all goal conditions are satisfied in current state
-    for (int i = 0; i < goalState->count; i++) {
-        if (!conditionExists(currentState, goalState->conditions[i])) {
-            return 0; // Found a goal condition that's not satisfied
+    // Every goal bit must be set in the current state
+    for (int w = 0; w < blockWords; w++) {
+        if ((currentState->onTable[w] & goalState->onTable[w]) != goalState->onTable[w] ||
+            (currentState->clear[w] & goalState->clear[w]) != goalState->clear[w]) {
+            return 0;
+        }
+    }
+    if (goalState->armEmpty && !currentState->armEmpty) {
+        return 0;
+    }
+    if (goalState->holding != NO_BLOCK && currentState->holding != goalState->holding) {
+        return 0;
+    }
+    for (int b = 0; b < numBlocks; b++) {
+        if (goalState->on[b] != NO_BLOCK && currentState->on[b] != goalState->on[b]) {
+            return 0;
         }
     }
     return 1; // All goal conditions are satisfied
 }
 
+// Function to get the number of ints in a state key
+int stateKeyLength() {
+    return numBlocks + 4 * blockWords + 2;
+}
+
+// Function to flatten the conditions of a world state into 'key'. Two
+// states hold the same conditions exactly when their keys are equal; the
+// table order is only used for display and is left out.
+void makeStateKey(WorldState *state, int *key) {
+    memcpy(key, state->on, numBlocks * sizeof(int));
+    memcpy(key + numBlocks, state->onTable, blockWords * sizeof(BlockWord));
+    memcpy(key + numBlocks + 2 * blockWords, state->clear, blockWords * sizeof(BlockWord));
+    key[numBlocks + 4 * blockWords] = state->holding;
+    key[numBlocks + 4 * blockWords + 1] = state->armEmpty;
+}
+
+// Function to rebuild a world state (made by initWorldState) from its key
+void stateFromKey(int *key, WorldState *state) {
+    memcpy(state->on, key, numBlocks * sizeof(int));
+    memcpy(state->onTable, key + numBlocks, blockWords * sizeof(BlockWord));
+    memcpy(state->clear, key + numBlocks + 2 * blockWords, blockWords * sizeof(BlockWord));
+    state->holding = key[numBlocks + 4 * blockWords];
+    state->armEmpty = key[numBlocks + 4 * blockWords + 1];
+    for (int b = 0; b < numBlocks; b++) {
+        state->above[b] = NO_BLOCK;
+        state->tableRank[b] = 0;
+    }
+    for (int b = 0; b < numBlocks; b++) {
+        if (state->on[b] != NO_BLOCK) {
+            state->above[state->on[b]] = b;
+        }
+    }
+    state->tableClock = 0;
+}
+
+// Function to record a state the planner has passed through (the start of
+// a round, or a failed action). Returns 1 if the list already held it: the
+// goal-stack planners are deterministic, so from there they would go round
+// in the same circle forever.
+int stateRepeats(WorldState *state, int **states, int *count) {
+    int length = stateKeyLength();
+    *states = realloc(*states, (size_t)(*count + 1) * length * sizeof(int));
+    int *key = *states + (size_t)*count * length;
+    makeStateKey(state, key);
+    for (int r = 0; r < *count; r++) {
+        if (memcmp(*states + (size_t)r * length, key, length * sizeof(int)) == 0) {
+            return 1;
+        }
+    }
+    (*count)++;
+    return 0;
+}
+
 // Function to perform goal stack planning with goals added top-to-bottom
 void performTopToBottomPlanning(WorldState *initialState, WorldState *goalState) {
-    WorldState currentState = {0};
+    WorldState currentState;
+    initWorldState(&currentState);
     copyWorldState(&currentState, initialState);
+    Condition *goals = malloc((3 * numBlocks + 1) * sizeof(Condition));
+    int goalCount = listConditions(goalState, goals);
+    int *roundStates = NULL;
+    int rounds = 0;
+    int *retryStates = NULL;    // States in which an action of this round failed
+    int retries = 0;
+    clock_t start = clock();
     
     // Set current history to top-to-bottom
     currentHistory = &topToBottomHistory;
     currentHistory->count = 0;
+    currentHistory->completed = 0;
     
     printf("APPROACH 1: TOP-TO-BOTTOM GOAL STACK PLANNING\n");
     
     resetGoalStack();
+    stateRepeats(&currentState, &roundStates, &rounds);
     
     // First push the combined goal marker
     StackElement combinedGoal;
@@ -738,31 +1076,43 @@ void performTopToBottomPlanning(WorldState *initialState, WorldState *goalState)
     push(combinedGoal);
     
     // Then add each goal condition to the stack from top to bottom (last to first)
-    for (int i = goalState->count - 1; i >= 0; i--) {
+    for (int i = goalCount - 1; i >= 0; i--) {
         StackElement element;
         element.type = GOAL;
-        element.element.condition = goalState->conditions[i];
+        element.element.condition = goals[i];
         push(element);
     }
     
-    printf("Starting Goal Stack Planning (Top-to-Bottom)\n");
+    if (verbose) {
+        printf("Starting Goal Stack Planning (Top-to-Bottom)\n");
+    }
     printStack();
     
     // Main planning loop
     while (stackTop >= 0) {
         // Check if only the combined goal remains
         if (stackTop == 0 && goalStack[0].type == COMBINED_GOAL) {
-            printf("Checking if goal state has been reached...\n");
+            if (verbose) {
+                printf("Checking if goal state has been reached...\n");
+            }
             if (matchesGoalState(&currentState, goalState)) {
                 printf("Goal state reached! Planning complete.\n");
+                currentHistory->completed = 1;
+                break;
+            } else if (stateRepeats(&currentState, &roundStates, &rounds)) {
+                printf("Planning stopped: round %d starts from the same state as an earlier round, "
+                       "so the goals would keep undoing each other.\n", rounds + 1);
                 break;
             } else {
-                printf("Goal state not yet reached. Pushing goals back onto stack.\n");
+                if (verbose) {
+                    printf("Goal state not yet reached. Pushing goals back onto stack.\n");
+                }
+                retries = 0;
                 // Add each goal condition to the stack from top to bottom again
-                for (int i = goalState->count - 1; i >= 0; i--) {
+                for (int i = goalCount - 1; i >= 0; i--) {
                     StackElement element;
                     element.type = GOAL;
-                    element.element.condition = goalState->conditions[i];
+                    element.element.condition = goals[i];
                     push(element);
                 }
                 printStack();
@@ -777,18 +1127,39 @@ void performTopToBottomPlanning(WorldState *initialState, WorldState *goalState)
             Condition goal = top.element.condition;
             
             if (conditionExists(&currentState, goal)) {
-                printf("Goal already satisfied: ");
-                printCondition(goal);
-                printf("\n");
+                if (verbose) {
+                    printf("Goal already satisfied: ");
+                    printCondition(goal);
+                    printf("\n");
+                }
             } else {
                 // Push it back and try to achieve it
                 push(top);
-                achieveGoal(&currentState, goal);
+                if (!achieveGoal(&currentState, goal)) {
+                    printf("Planning stopped: no operation achieves the goal ");
+                    printCondition(goal);
+                    printf(" from the current state.\n");
+                    break;
+                }
             }
         } else if (top.type == ACTION) {
             // If it's an action, execute it
             Operation action = top.element.operation;
-            executeOperation(&currentState, action);
+            if (!executeOperation(&currentState, action)) {
+                // A goal achieved after the preconditions undid one of them:
+                // achieve them again, unless this failed from the same state
+                // before in this round
+                if (stateRepeats(&currentState, &retryStates, &retries)) {
+                    printf("Planning stopped: the preconditions of ");
+                    printOperation(action);
+                    printf(" keep being undone.\n");
+                    break;
+                }
+                push(top);
+                addPreconditions(action);
+                printStack();
+                continue;
+            }
             printWorldState(currentState);
             visualizeStacks(currentState);
         }
@@ -800,22 +1171,39 @@ void performTopToBottomPlanning(WorldState *initialState, WorldState *goalState)
     printf("Planning complete! Final state (Top-to-Bottom):\n");
     printWorldState(currentState);
     visualizeStacks(currentState);
+    
+    currentHistory->seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    topToBottomPeak = stackPeak;
+    free(goals);
+    free(roundStates);
+    free(retryStates);
+    freeWorldState(&currentState);
 }
 
 // Function to perform goal stack planning with goals added bottom-to-top
 void performBottomToTopPlanning(WorldState *initialState, WorldState *goalState) {
-    WorldState currentState = {0};
+    WorldState currentState;
+    initWorldState(&currentState);
     copyWorldState(&currentState, initialState);
+    Condition *goals = malloc((3 * numBlocks + 1) * sizeof(Condition));
+    int goalCount = listConditions(goalState, goals);
+    int *roundStates = NULL;
+    int rounds = 0;
+    int *retryStates = NULL;    // States in which an action of this round failed
+    int retries = 0;
+    clock_t start = clock();
     
     // Set current history to bottom-to-top
     currentHistory = &bottomToTopHistory;
     currentHistory->count = 0;
+    currentHistory->completed = 0;
     
     printf("\n\n====================================\n");
     printf("APPROACH 2: BOTTOM-TO-TOP GOAL STACK PLANNING\n");
     printf("====================================\n\n");
     
     resetGoalStack();
+    stateRepeats(&currentState, &roundStates, &rounds);
     
     // First push the combined goal marker
     StackElement combinedGoal;
@@ -823,31 +1211,43 @@ void performBottomToTopPlanning(WorldState *initialState, WorldState *goalState)
     push(combinedGoal);
     
     // Then add each goal condition to the stack from bottom to top (first to last)
-    for (int i = 0; i < goalState->count; i++) {
+    for (int i = 0; i < goalCount; i++) {
         StackElement element;
         element.type = GOAL;
-        element.element.condition = goalState->conditions[i];
+        element.element.condition = goals[i];
         push(element);
     }
     
-    printf("Starting Goal Stack Planning (Bottom-to-Top)\n");
+    if (verbose) {
+        printf("Starting Goal Stack Planning (Bottom-to-Top)\n");
+    }
     printStack();
     
     // Main planning loop
     while (stackTop >= 0) {
         // Check if only the combined goal remains
         if (stackTop == 0 && goalStack[0].type == COMBINED_GOAL) {
-            printf("Checking if goal state has been reached...\n");
+            if (verbose) {
+                printf("Checking if goal state has been reached...\n");
+            }
             if (matchesGoalState(&currentState, goalState)) {
                 printf("Goal state reached! Planning complete.\n");
+                currentHistory->completed = 1;
+                break;
+            } else if (stateRepeats(&currentState, &roundStates, &rounds)) {
+                printf("Planning stopped: round %d starts from the same state as an earlier round, "
+                       "so the goals would keep undoing each other.\n", rounds + 1);
                 break;
             } else {
-                printf("Goal state not yet reached. Pushing goals back onto stack.\n");
+                if (verbose) {
+                    printf("Goal state not yet reached. Pushing goals back onto stack.\n");
+                }
+                retries = 0;
                 // Add each goal condition to the stack from bottom to top again
-                for (int i = 0; i < goalState->count; i++) {
+                for (int i = 0; i < goalCount; i++) {
                     StackElement element;
                     element.type = GOAL;
-                    element.element.condition = goalState->conditions[i];
+                    element.element.condition = goals[i];
                     push(element);
                 }
                 printStack();
@@ -862,18 +1262,39 @@ void performBottomToTopPlanning(WorldState *initialState, WorldState *goalState)
             Condition goal = top.element.condition;
             
             if (conditionExists(&currentState, goal)) {
-                printf("Goal already satisfied: ");
-                printCondition(goal);
-                printf("\n");
+                if (verbose) {
+                    printf("Goal already satisfied: ");
+                    printCondition(goal);
+                    printf("\n");
+                }
             } else {
                 // Push it back and try to achieve it
                 push(top);
-                achieveGoal(&currentState, goal);
+                if (!achieveGoal(&currentState, goal)) {
+                    printf("Planning stopped: no operation achieves the goal ");
+                    printCondition(goal);
+                    printf(" from the current state.\n");
+                    break;
+                }
             }
         } else if (top.type == ACTION) {
             // If it's an action, execute it
             Operation action = top.element.operation;
-            executeOperation(&currentState, action);
+            if (!executeOperation(&currentState, action)) {
+                // A goal achieved after the preconditions undid one of them:
+                // achieve them again, unless this failed from the same state
+                // before in this round
+                if (stateRepeats(&currentState, &retryStates, &retries)) {
+                    printf("Planning stopped: the preconditions of ");
+                    printOperation(action);
+                    printf(" keep being undone.\n");
+                    break;
+                }
+                push(top);
+                addPreconditions(action);
+                printStack();
+                continue;
+            }
             printWorldState(currentState);
             visualizeStacks(currentState);
         }
@@ -884,17 +1305,381 @@ void performBottomToTopPlanning(WorldState *initialState, WorldState *goalState)
     
     printf("Planning complete! Final state (Bottom-to-Top):\n");
     printWorldState(currentState);
-    visualizeStacks(currentState);  
+    visualizeStacks(currentState);
+    
+    currentHistory->seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    bottomToTopPeak = stackPeak;
+    free(goals);
+    free(roundStates);
+    free(retryStates);
+    freeWorldState(&currentState);
+}
+
+// ---------------------------------------------------------------------------
+// Optimal planning: A* over world states with an admissible heuristic
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    int g;              // Operations from the initial state
+    int h;              // Heuristic estimate of the operations still needed
+    int parent;         // Node this one was reached from, -1 for the initial state
+    Operation op;       // Operation applied to the parent
+    int closed;         // Already expanded with this g
+} SearchNode;
+
+// Visited states (growable arrays of nodes and of their keys, plus an
+// open-addressing index) and the open list as a binary heap of node
+// indices ordered by f = g + h
+typedef struct {
+    SearchNode *nodes;
+    int *keys;          // keyLength ints per node
+    int keyLength;
+    int count;
+    int capacity;
+    int maxStates;      // Node limit that keeps the keys within SEARCH_MEMORY_LIMIT
+    int *index;         // Node of each slot, -1 when empty
+    int indexSize;      // Power of two, kept at least twice the node count
+    int *heap;
+    int heapCount;
+    int heapCapacity;
+    int *wellPlaced;    // Scratch space of heuristicCost
+    int *chain;
+} StateSpace;
+
+unsigned int hashStateKey(int *key, int length) {
+    // FNV-1a over the key bytes
+    unsigned int hash = 2166136261u;
+    unsigned char *bytes = (unsigned char *)key;
+    for (size_t i = 0; i < length * sizeof(int); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
 }
 
-// Function to print summary comparison of both approaches
+// Lower bound on the operations left. A block is well placed when the goal
+// puts it where it is and everything under it is well placed too. A block
+// that is not must be moved at least once (two operations), one held by
+// the arm needs at least one more, and a block sitting on its goal block
+// while that block is not well placed has to be moved off and back (four).
+int heuristicCost(StateSpace *space, WorldState *state, WorldState *goal) {
+    int *wellPlaced = space->wellPlaced;
+    int *chain = space->chain;
+    int cost = 0;
+    
+    for (int b = 0; b < numBlocks; b++) {
+        wellPlaced[b] = -1;
+    }
+    for (int b = 0; b < numBlocks; b++) {
+        int constrained = testBit(goal->onTable, b) || goal->on[b] != NO_BLOCK;
+        if (!constrained) {
+            continue;
+        }
+        if (state->holding == b) {
+            cost += 1;
+            continue;
+        }
+        
+        // Walk down until the answer is known, then fill it in going back up
+        int length = 0;
+        int current = b;
+        int placed;
+        while (1) {
+            if (wellPlaced[current] >= 0) {
+                placed = wellPlaced[current];
+                break;
+            }
+            if (testBit(goal->onTable, current)) {
+                placed = testBit(state->onTable, current);
+                wellPlaced[current] = placed;
+                break;
+            }
+            if (goal->on[current] == NO_BLOCK) {
+                // Unconstrained blocks never need to move
+                placed = 1;
+                wellPlaced[current] = placed;
+                break;
+            }
+            if (state->on[current] != goal->on[current] || length == numBlocks) {
+                placed = 0;
+                wellPlaced[current] = placed;
+                break;
+            }
+            chain[length++] = current;
+            current = goal->on[current];
+        }
+        while (length > 0) {
+            wellPlaced[chain[--length]] = placed;
+        }
+        
+        if (!wellPlaced[b]) {
+            cost += (goal->on[b] != NO_BLOCK && state->on[b] == goal->on[b]) ? 4 : 2;
+        }
+    }
+    return cost;
+}
+
+// Find the node for 'key', adding it when it is new. Returns -1 once the
+// node limit is reached.
+int findOrAddState(StateSpace *space, int *key, int *isNew) {
+    int length = space->keyLength;
+    if (2 * (space->count + 1) > space->indexSize) {
+        int newSize = space->indexSize > 0 ? space->indexSize * 2 : 1024;
+        int *newIndex = malloc(newSize * sizeof(int));
+        for (int i = 0; i < newSize; i++) {
+            newIndex[i] = -1;
+        }
+        for (int n = 0; n < space->count; n++) {
+            unsigned int slot = hashStateKey(space->keys + (size_t)n * length, length) & (newSize - 1);
+            while (newIndex[slot] >= 0) {
+                slot = (slot + 1) & (newSize - 1);
+            }
+            newIndex[slot] = n;
+        }
+        free(space->index);
+        space->index = newIndex;
+        space->indexSize = newSize;
+    }
+    
+    unsigned int slot = hashStateKey(key, length) & (space->indexSize - 1);
+    while (space->index[slot] >= 0) {
+        int node = space->index[slot];
+        if (memcmp(space->keys + (size_t)node * length, key, length * sizeof(int)) == 0) {
+            *isNew = 0;
+            return node;
+        }
+        slot = (slot + 1) & (space->indexSize - 1);
+    }
+    if (space->count >= space->maxStates) {
+        return -1;
+    }
+    if (space->count == space->capacity) {
+        space->capacity = space->capacity > 0 ? space->capacity * 2 : 1024;
+        if (space->capacity > space->maxStates) {
+            space->capacity = space->maxStates;
+        }
+        space->nodes = realloc(space->nodes, space->capacity * sizeof(SearchNode));
+        space->keys = realloc(space->keys, (size_t)space->capacity * length * sizeof(int));
+    }
+    space->index[slot] = space->count;
+    memcpy(space->keys + (size_t)space->count * length, key, length * sizeof(int));
+    *isNew = 1;
+    return space->count++;
+}
+
+// Heap order: smaller f first, deeper node first among equal f
+int heapBefore(StateSpace *space, int a, int b) {
+    SearchNode *x = &space->nodes[a];
+    SearchNode *y = &space->nodes[b];
+    if (x->g + x->h != y->g + y->h) {
+        return x->g + x->h < y->g + y->h;
+    }
+    return x->g > y->g;
+}
+
+void heapPush(StateSpace *space, int node) {
+    if (space->heapCount == space->heapCapacity) {
+        space->heapCapacity = space->heapCapacity > 0 ? space->heapCapacity * 2 : 1024;
+        space->heap = realloc(space->heap, space->heapCapacity * sizeof(int));
+    }
+    int i = space->heapCount++;
+    while (i > 0 && heapBefore(space, node, space->heap[(i - 1) / 2])) {
+        space->heap[i] = space->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    space->heap[i] = node;
+}
+
+int heapPop(StateSpace *space) {
+    int top = space->heap[0];
+    int last = space->heap[--space->heapCount];
+    int i = 0;
+    while (2 * i + 1 < space->heapCount) {
+        int child = 2 * i + 1;
+        if (child + 1 < space->heapCount && heapBefore(space, space->heap[child + 1], space->heap[child])) {
+            child++;
+        }
+        if (!heapBefore(space, space->heap[child], last)) {
+            break;
+        }
+        space->heap[i] = space->heap[child];
+        i = child;
+    }
+    space->heap[i] = last;
+    return top;
+}
+
+// Function to list the operations whose preconditions hold in a state.
+// The array needs room for numBlocks + 1 operations.
+int applicableOperations(WorldState *state, Operation *ops) {
+    int count = 0;
+    
+    if (state->holding != NO_BLOCK) {
+        // PUTDOWN(x) needs HOLDING(x); STACK(x,y) also needs CLEAR(y)
+        ops[count++] = (Operation){.type = PUTDOWN, .block1 = state->holding};
+        for (int b = 0; b < numBlocks; b++) {
+            int placed = testBit(state->onTable, b) || state->on[b] != NO_BLOCK;
+            if (placed && testBit(state->clear, b)) {
+                ops[count++] = (Operation){.type = STACK, .block1 = state->holding, .block2 = b};
+            }
+        }
+    } else if (state->armEmpty) {
+        // PICKUP(x) needs ONTABLE(x), UNSTACK(x,y) needs ON(x,y); both need CLEAR(x)
+        for (int b = 0; b < numBlocks; b++) {
+            if (!testBit(state->clear, b)) {
+                continue;
+            }
+            if (testBit(state->onTable, b)) {
+                ops[count++] = (Operation){.type = PICKUP, .block1 = b};
+            } else if (state->on[b] != NO_BLOCK) {
+                ops[count++] = (Operation){.type = UNSTACK, .block1 = b, .block2 = state->on[b]};
+            }
+        }
+    }
+    return count;
+}
+
+// Function to find a shortest plan with A*. The plan goes to
+// optimalHistory; returns 0 if the goal is unreachable or the states did
+// not fit in SEARCH_MEMORY_LIMIT.
+int performOptimalPlanning(WorldState *initialState, WorldState *goalState) {
+    StateSpace space = {0};
+    int isNew;
+    int goalNode = -1;
+    clock_t start = clock();
+    
+    printf("\n\n====================================\n");
+    printf("APPROACH 3: OPTIMAL PLANNING WITH A* SEARCH\n");
+    printf("====================================\n\n");
+    
+    optimalHistory.count = 0;
+    optimalHistory.completed = 0;
+    optimalExpanded = 0;
+    
+    space.keyLength = stateKeyLength();
+    space.maxStates = SEARCH_MEMORY_LIMIT / (space.keyLength * sizeof(int) + sizeof(SearchNode) + 3 * sizeof(int));
+    space.wellPlaced = malloc(numBlocks * sizeof(int));
+    space.chain = malloc(numBlocks * sizeof(int));
+    int *key = malloc(space.keyLength * sizeof(int));
+    Operation *ops = malloc((numBlocks + 1) * sizeof(Operation));
+    WorldState state, next;
+    initWorldState(&state);
+    initWorldState(&next);
+    
+    makeStateKey(initialState, key);
+    int first = findOrAddState(&space, key, &isNew);
+    space.nodes[first].g = 0;
+    space.nodes[first].h = heuristicCost(&space, initialState, goalState);
+    space.nodes[first].parent = -1;
+    space.nodes[first].closed = 0;
+    heapPush(&space, first);
+    
+    while (space.heapCount > 0) {
+        int node = heapPop(&space);
+        if (space.nodes[node].closed) {
+            continue; // Stale entry, the node was reached more cheaply later
+        }
+        space.nodes[node].closed = 1;
+        
+        stateFromKey(space.keys + (size_t)node * space.keyLength, &state);
+        if (matchesGoalState(&state, goalState)) {
+            goalNode = node;
+            break;
+        }
+        optimalExpanded++;
+        
+        int opCount = applicableOperations(&state, ops);
+        for (int i = 0; i < opCount; i++) {
+            copyWorldState(&next, &state);
+            applyOperation(&next, ops[i]);
+            makeStateKey(&next, key);
+            
+            int child = findOrAddState(&space, key, &isNew);
+            if (child < 0) {
+                printf("Error: Search space exceeds %d states (%zu MB of states)\n", space.maxStates,
+                       SEARCH_MEMORY_LIMIT >> 20);
+                space.heapCount = 0;
+                break;
+            }
+            int g = space.nodes[node].g + 1;
+            if (!isNew && g >= space.nodes[child].g) {
+                continue;
+            }
+            if (isNew) {
+                space.nodes[child].h = heuristicCost(&space, &next, goalState);
+            }
+            space.nodes[child].g = g;
+            space.nodes[child].parent = node;
+            space.nodes[child].op = ops[i];
+            space.nodes[child].closed = 0;
+            heapPush(&space, child);
+        }
+    }
+    optimalGenerated = space.count;
+    
+    if (goalNode >= 0) {
+        // Follow the parents back to the start, then store the plan forwards
+        int length = space.nodes[goalNode].g;
+        Operation *plan = malloc((length > 0 ? length : 1) * sizeof(Operation));
+        for (int node = goalNode, i = length - 1; space.nodes[node].parent >= 0; node = space.nodes[node].parent, i--) {
+            plan[i] = space.nodes[node].op;
+        }
+        currentHistory = &optimalHistory;
+        for (int i = 0; i < length; i++) {
+            addToHistory(plan[i]);
+        }
+        free(plan);
+        optimalHistory.completed = 1;
+        
+        printf("Optimal plan found: %d operations, %ld states expanded, %ld states generated\n",
+               length, optimalExpanded, optimalGenerated);
+    } else {
+        printf("No plan found after expanding %ld states\n", optimalExpanded);
+    }
+    optimalHistory.seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    
+    freeWorldState(&state);
+    freeWorldState(&next);
+    free(key);
+    free(ops);
+    free(space.nodes);
+    free(space.keys);
+    free(space.index);
+    free(space.heap);
+    free(space.wellPlaced);
+    free(space.chain);
+    return goalNode >= 0;
+}
+
+// Function to print how long a planner took and whether it finished
+void printPlannerCost(const char *name, OperationHistory history, int stackPeak) {
+    printf("%s: %.3f ms", name, history.seconds * 1000.0);
+    if (stackPeak > 0) {
+        printf(", goal stack peaked at %d entries", stackPeak);
+    }
+    printf("%s\n", history.completed ? "" : " (did not reach the goal)");
+}
+
+// Function to print how much longer a goal-stack plan is than the A* plan.
+// A plan that stopped short of the goal is not comparable.
+void printOptimalGap(const char *name, OperationHistory history) {
+    if (history.completed) {
+        printf("%s plan is %d operations longer than optimal.\n", name, history.count - optimalHistory.count);
+    } else {
+        printf("%s plan did not reach the goal.\n", name);
+    }
+}
+
+// Function to print summary comparison of all approaches
 void printOperationSummary() {
     printf("\n\n====================================\n");
-    printf("COMPARISON OF BOTH APPROACHES\n");
+    printf("COMPARISON OF ALL APPROACHES\n");
     printf("====================================\n");
     
     printOperationHistory(topToBottomHistory, "Operations performed by Top-to-Bottom approach");
     printOperationHistory(bottomToTopHistory, "Operations performed by Bottom-to-Top approach");
+    if (optimalHistory.completed) {
+        printOperationHistory(optimalHistory, "Operations in the optimal (A*) plan");
+    }
     
     // Compare number of operations
     printf("Top-to-Bottom approach used %d operations.\n", topToBottomHistory.count);
@@ -909,81 +1694,138 @@ void printOperationSummary() {
     } else {
         printf("Both approaches used the same number of operations.\n");
     }
+    
+    // Compare both against the shortest plan
+    if (optimalHistory.completed) {
+        printf("A* found a %d-operation plan (%ld states expanded, %ld generated).\n",
+               optimalHistory.count, optimalExpanded, optimalGenerated);
+        printOptimalGap("Top-to-Bottom", topToBottomHistory);
+        printOptimalGap("Bottom-to-Top", bottomToTopHistory);
+    } else {
+        printf("A* found no plan (%ld states expanded).\n", optimalExpanded);
+    }
+    
+    // Time and memory
+    printf("\n");
+    printPlannerCost("Top-to-Bottom", topToBottomHistory, topToBottomPeak);
+    printPlannerCost("Bottom-to-Top", bottomToTopHistory, bottomToTopPeak);
+    printPlannerCost("A*", optimalHistory, 0);
+    
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        printf("Peak memory: %ld KB\n", usage.ru_maxrss);
+    }
 }
 
-int main() {
-    WorldState initialState = {0};
-    WorldState goalState = {0};
-    char input[MAX_STRING_LEN];
-    int i;
+// Function to read the stacks of one state, one line per stack
+int readStacks(WorldState *state, int numStacks, char **line, size_t *lineSize) {
+    for (int i = 0; i < numStacks; i++) {
+        if (verbose) {
+            printf("Stack %d: ", i + 1);
+        }
+        if (getline(line, lineSize, stdin) < 0) {
+            printf("Error: Expected %d stacks, input ended after %d\n", numStacks, i);
+            return 0;
+        }
+        if (!parseStack(state, *line)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    WorldState initialState;
+    WorldState goalState;
+    char *line = NULL;
+    size_t lineSize = 0;
     
-    // Initialize the arm as empty
-    Condition armEmptyCondition;
-    armEmptyCondition.type = ARMEMPTY;
-    addCondition(&initialState, armEmptyCondition);
+    // --quiet leaves out the goal-stack trace and the state dumps
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quiet") == 0) {
+            verbose = 0;
+        } else {
+            printf("Usage: %s [--quiet]\n", argv[0]);
+            return 1;
+        }
+    }
     
     // Get number of blocks
     printf("Enter the number of blocks: ");
-    int numBlocks;
-    scanf("%d", &numBlocks);
-    getchar(); // Clear newline
-    
-    if (numBlocks <= 0 || numBlocks > MAX_BLOCKS) {
-        printf("Error: Invalid number of blocks. Must be between 1 and %d.\n", MAX_BLOCKS);
+    if (scanf("%d", &numBlocks) != 1 || numBlocks <= 0) {
+        printf("Error: Invalid number of blocks. Must be at least 1.\n");
         return 1;
     }
+    getchar(); // Clear newline
+    
+    initBlocks(numBlocks);
+    initWorldState(&initialState);
+    initWorldState(&goalState);
+    
+    // Initialize the arm as empty
+    Condition armEmptyCondition = {.type = ARMEMPTY};
+    addCondition(&initialState, armEmptyCondition);
     
     // Get initial state
     printf("Enter the number of stacks in the initial state: ");
     int numInitialStacks;
-    scanf("%d", &numInitialStacks);
-    getchar(); // Clear newline
-    
-    if (numInitialStacks <= 0 || numInitialStacks > numBlocks) {
+    if (scanf("%d", &numInitialStacks) != 1 || numInitialStacks <= 0 || numInitialStacks > numBlocks) {
         printf("Error: Invalid number of stacks. Must be between 1 and %d.\n", numBlocks);
         return 1;
     }
+    getchar(); // Clear newline
     
     printf("Enter the initial stacks (e.g., \"A B\" for B on top of A):\n");
-    for (i = 0; i < numInitialStacks; i++) {
-        printf("Stack %d: ", i + 1);
-        fgets(input, MAX_STRING_LEN, stdin);
-        parseStack(&initialState, input);
+    if (!readStacks(&initialState, numInitialStacks, &line, &lineSize)) {
+        return 1;
     }
     
     // Get goal state
     printf("\nEnter the number of stacks in the goal state: ");
     int numGoalStacks;
-    scanf("%d", &numGoalStacks);
-    getchar(); // Clear newline
-    
-    if (numGoalStacks <= 0 || numGoalStacks > numBlocks) {
+    if (scanf("%d", &numGoalStacks) != 1 || numGoalStacks <= 0 || numGoalStacks > numBlocks) {
         printf("Error: Invalid number of stacks. Must be between 1 and %d.\n", numBlocks);
         return 1;
     }
+    getchar(); // Clear newline
     
     printf("Enter the goal stacks (e.g., \"A B\" for B on top of A):\n");
-    for (i = 0; i < numGoalStacks; i++) {
-        printf("Stack %d: ", i + 1);
-        fgets(input, MAX_STRING_LEN, stdin);
-        parseStack(&goalState, input);
+    if (!readStacks(&goalState, numGoalStacks, &line, &lineSize)) {
+        return 1;
     }
+    free(line);
+    sortBlocksByName(&initialState, &goalState);
     
     // Print the initial and goal states
-    printf("\nInitial State:\n");
-    printWorldState(initialState);
-    visualizeStacks(initialState);
-    
-    printf("Goal State:\n");
-    printWorldState(goalState);
-    visualizeStacks(goalState);
+    if (verbose) {
+        printf("\nInitial State:\n");
+        printWorldState(initialState);
+        visualizeStacks(initialState);
+        
+        printf("Goal State:\n");
+        printWorldState(goalState);
+        visualizeStacks(goalState);
+    }
     
-    // Perform planning with both approaches
+    // Perform planning with all three approaches
     performTopToBottomPlanning(&initialState, &goalState);
     performBottomToTopPlanning(&initialState, &goalState);
+    performOptimalPlanning(&initialState, &goalState);
     
     // Print summary of operations
     printOperationSummary();
     
+    freeWorldState(&initialState);
+    freeWorldState(&goalState);
+    free(goalStack);
+    free(topToBottomHistory.operations);
+    free(bottomToTopHistory.operations);
+    free(optimalHistory.operations);
+    for (int i = 0; i < namedBlocks; i++) {
+        free(blockNames[i]);
+    }
+    free(blockNames);
+    free(nameIndex);
+    
     return 0;
 } 
\ No newline at end of file
@@ -1,42 +1,351 @@
-
+// Build: gcc -O2 -march=native -pthread cryptarithmetic.c -o cryptarithmetic -ldl
+// Library (no main, see cryptarithmetic.h): add -DCRYPTARITHMETIC_LIBRARY -c
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <stdarg.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <math.h>
+#include <dlfcn.h>
+#include "cryptarithmetic.h"
 
-#define MAX_LEN 20
+#define MAX_LEN 128  // Word buffer size: words are capped at 127 characters plus the terminator
 #define MAX_WORDS 10
-#define MAX_UNIQUE_CHARS 10 // Max unique characters allowed (0-9 digits)
+#define MAX_BASE 64
+#define MAX_UNIQUE_CHARS MAX_BASE // One digit per letter, so never more letters than the base
+// Undo entries kept by the propagation solver: enough for every domain to lose
+// its digits and every carry bound to move one step at a time
+#define MAX_TRAIL (MAX_UNIQUE_CHARS * MAX_BASE + 2 * (MAX_LEN + 1) * MAX_WORDS)
+#define MAX_THREADS 64
+#define TASKS_PER_THREAD 16 // Parallel search splits until it has this many tasks per thread
+#define PERMUTATION_LANES 4 // Digit subsets checked side by side by the permutation kernel
+#define MEMO_ENTRIES (1 << 15) // Default size of the column solver's memo table
+#define MEMO_WAYS 2            // Entries per memo bucket
+#define MODULAR_NODE_LIMIT (1 << 12) // Nodes per suffix length in the modular pre-analysis
+#define MAX_SIGNATURE (MAX_WORDS * (MAX_LEN + 1) + 8)
+#define CACHE_MAX_SOLUTIONS (1 << 16)   // Larger solution sets are not cached
+#define CANCEL_POLL_INTERVAL 1024       // Search nodes between checks of the cancellation token
+#define KERNEL_SYMBOL "alphameticKernel"
+#define MEET_MAX_ENTRIES (1 << 12)      // Largest half the meet-in-the-middle solver tabulates
+
+// One 64-bit value per lane (GCC vector extension, maps to SSE/AVX/NEON)
+typedef long long LaneVector __attribute__((vector_size(8 * PERMUTATION_LANES)));
+
+// Set of digits still possible for a letter: bit d is set when d is allowed
+typedef uint64_t DigitMask;
+#define DIGIT_BIT(d) ((DigitMask)1 << (d))
+
+// Digits 0..base-1
+static inline DigitMask allDigits(int base) {
+    return base >= 64 ? ~(DigitMask)0 : DIGIT_BIT(base) - 1;
+}
+
+typedef struct MemoTable MemoTable;
 
 // Structure to hold puzzle information
-typedef struct {
+struct Puzzle {
     char words[MAX_WORDS][MAX_LEN]; // Array to store multiple words
     char result[MAX_LEN];           // Result word
     int numWords;                   // Number of words in the puzzle
     char uniqueChars[MAX_UNIQUE_CHARS];
     int numUniqueChars;
     int assigned[MAX_UNIQUE_CHARS]; // Values assigned to each unique character
-    bool used[10];                  // Tracks which digits (0-9) have been used
-    int solutionCount;              // Count of solutions found
+    bool used[MAX_BASE];            // Tracks which digits (0..base-1) have been used
+    int base;                       // Number base of the puzzle (2..MAX_BASE)
+    long long solutionCount;        // Count of solutions found
     
     // Constraint arrays
     bool canBeZero[MAX_UNIQUE_CHARS];   // Whether a character can be assigned 0
-    bool possibleDigits[MAX_UNIQUE_CHARS][10]; // Possible digits for each char
+    DigitMask domain[MAX_UNIQUE_CHARS];     // Possible digits for each char
     bool fixedAssignment[MAX_UNIQUE_CHARS]; // Whether this character has fixed assignment
-} Puzzle;
+    
+    // Column model, least significant column first (built by buildColumns)
+    int numColumns;
+    int columnLetters[MAX_LEN][MAX_WORDS]; // Letters of the input words in each column
+    int columnLetterCount[MAX_LEN];
+    int resultLetter[MAX_LEN];             // Letter of the result in each column (-1 if none)
+    
+    // Column equations: sum(termCoef * letter) + carryIn - base * carryOut = 0
+    int columnTermCount[MAX_LEN];
+    int columnTermLetter[MAX_LEN][MAX_WORDS + 1];
+    int columnTermCoef[MAX_LEN][MAX_WORDS + 1];
+    
+    // Whole puzzle as one linear equation: sum(letterCoef[i] * digit_i) = 0
+    long long letterCoef[MAX_UNIQUE_CHARS];
+    
+    SolutionHandler onSolution;
+    void *solutionContext;
+    
+    bool verbose;                   // Print analysis and progress messages
+    long long nodes;                // Search nodes visited by the last solve
+    long long prunes;               // Branches cut by a constraint check
+    long long backtracks;           // Branches tried and undone without a solution
+    long maxSolutions;              // Stop after this many solutions (0 = find all)
+    bool stopped;                   // Set once maxSolutions is reached
+    
+    VariableOrder variableOrder;    // Branching order of the propagation solver
+    int branchOrder[MAX_UNIQUE_CHARS];  // Static order of the letters (prepareBranchOrder)
+    
+    MemoTable *memo;                // Column solver memo (NULL when disabled)
+    int memoEntries;                // Size of the memo table, 0 disables it
+    bool countOnly;                 // Solutions are only counted, so counts may be reused
+    long long memoHits;
+    long long tableBytes;           // Memory of the meet-in-the-middle table of the last search
+    
+    const char *dimacsPath;         // SAT solver writes its CNF here when set
+    const char *kernelPath;         // Specialised solver keeps its generated C source here when set
+    
+    SolutionCache *cache;           // Solutions of isomorphic puzzles (NULL when disabled)
+    bool cacheHit;                  // Last solve was answered from the cache
+    const atomic_bool *cancel;      // The caller sets it to stop the search (NULL if unused)
+};
+
+// A state of the column solver at the start of a column. What is left to
+// solve depends only on the column, the carry into it, the digits already
+// used and the digits of the assigned letters that appear again in this or
+// later columns (the column's boundary letters).
+typedef struct {
+    bool valid;
+    int column;
+    int carry;
+    DigitMask used;
+    unsigned char digits[MAX_UNIQUE_CHARS];
+    long long solutions;        // Solutions below this state (0: a nogood)
+    long long work;             // Nodes it took to search; cheaper entries are replaced first
+} MemoEntry;
+
+struct MemoTable {
+    MemoEntry *entries;
+    size_t numBuckets;                              // Power of two, MEMO_WAYS entries each
+    size_t maxBuckets;                              // Growth limit set by the memo size
+    int boundary[MAX_LEN][MAX_UNIQUE_CHARS];
+    int boundaryCount[MAX_LEN];
+    long long stores;
+};
+
+// What a trail entry restores
+typedef enum {
+    TRAIL_DOMAIN,
+    TRAIL_CARRY_LO,
+    TRAIL_CARRY_HI
+} TrailKind;
+
+typedef struct {
+    TrailKind kind;
+    int index;
+    long long oldValue;
+} TrailEntry;
+
+// Search state of the propagation solver. Every narrowing is recorded on the
+// trail so a branch is undone by unwinding to the mark taken before it.
+typedef struct {
+    DigitMask domain[MAX_UNIQUE_CHARS];
+    int carryLo[MAX_LEN + 1];   // Bounds of the carry into each column
+    int carryHi[MAX_LEN + 1];
+    TrailEntry trail[MAX_TRAIL];
+    int trailSize;
+} PropagationState;
+
+// Branching plan of the linear-equation solver, built once per puzzle
+typedef struct {
+    int numFree;                                  // Letters left to branch on
+    int order[MAX_UNIQUE_CHARS];                  // Largest |coefficient| first
+    long long suffixMin[MAX_UNIQUE_CHARS + 1];    // Least that order[k..] can still add
+    long long suffixMax[MAX_UNIQUE_CHARS + 1];    // Most that order[k..] can still add
+    long long fixedSum;                           // Contribution of pre-assigned letters
+} LinearPlan;
+
+// Solutions collected by one parallel task, stored as digits per letter
+typedef struct {
+    unsigned char *digits;
+    long long count;
+    long long capacity;
+    long long countedOnly;  // Solutions nobody reads under countOnly, kept as a number only
+} SolutionList;
+
+// A subtree of the linear search: the first 'depth' letters of the plan order
+// fixed to 'prefix'
+typedef struct {
+    int depth;
+    unsigned char prefix[MAX_UNIQUE_CHARS];
+    long long partialSum;
+    SolutionList solutions;
+    bool done;                  // Searched to the end, or to maxSolutions on its own
+} SearchTask;
+
+// Per-worker deque of task indexes. The owner pops from the bottom, idle
+// workers steal from the top.
+typedef struct {
+    int *items;
+    int top;
+    int bottom;
+    pthread_mutex_t lock;
+} TaskDeque;
+
+typedef struct {
+    const Puzzle *base;
+    const LinearPlan *plan;
+    SearchTask *tasks;
+    int numTasks;
+    TaskDeque *deques;
+    int numWorkers;
+    atomic_llong solutionCount;
+    atomic_long steals;
+    atomic_llong nodes;
+    atomic_llong prunes;
+    atomic_llong backtracks;
+    atomic_bool stop;           // The caller cancelled the search
+    // maxSolutions: tasks 0..cutoff already hold enough solutions, so the
+    // tasks after it can stop without changing what the merge reports
+    atomic_int cutoff;
+    int scanned;                // Tasks before this one are done...
+    long long prefixTotal;      // ...and found this many solutions together
+    pthread_mutex_t limitLock;
+} ParallelSearch;
+
+typedef struct {
+    ParallelSearch *search;
+    int id;
+    SearchTask *current;
+} WorkerContext;
+
+#define MAX_EXPR_NODES 256
+#define MAX_EXPR_CONSTRAINTS 32
+#define EXPR_BASE 10            // Expression systems mix words with decimal numbers
+
+// Node of a general alphametic expression. Identical sub-expressions are
+// created once and shared, so the expressions of a system form a DAG.
+typedef enum {
+    EXPR_WORD,
+    EXPR_NUMBER,
+    EXPR_ADD,
+    EXPR_SUB,
+    EXPR_MUL
+} ExprOp;
+
+typedef struct {
+    ExprOp op;
+    int left, right;                // Operands of ADD, SUB and MUL
+    int letters[MAX_LEN];           // EXPR_WORD: letter index per character
+    int length;
+    long long number;               // EXPR_NUMBER
+    int readyDepth;                 // Search depth at which all its letters are assigned
+} ExprNode;
+
+typedef enum {
+    REL_EQ,
+    REL_NE,
+    REL_LT,
+    REL_LE,
+    REL_GT,
+    REL_GE
+} Relation;
+
+typedef struct {
+    int left, right;
+    Relation relation;
+    int readyDepth;
+} ExprConstraint;
+
+// Values of expression nodes: products of long words quickly pass 64 bits
+typedef __int128 ExprValue;
+
+// A system of equations and inequalities over shared letters, e.g.
+// "AB*C=DEF; DEF-AB=GHI; A<C"
+typedef struct {
+    ExprNode nodes[MAX_EXPR_NODES];
+    int numNodes;
+    ExprConstraint constraints[MAX_EXPR_CONSTRAINTS];
+    int numConstraints;
+    
+    char letters[MAX_UNIQUE_CHARS];     // In branching order
+    int numLetters;
+    DigitMask domain[MAX_UNIQUE_CHARS];
+    int assigned[MAX_UNIQUE_CHARS];
+    bool used[EXPR_BASE];
+    
+    // Nodes and constraints that become computable at each depth
+    int nodeOrder[MAX_EXPR_NODES];
+    int nodeStart[MAX_UNIQUE_CHARS + 2];
+    int constraintOrder[MAX_EXPR_CONSTRAINTS];
+    int constraintStart[MAX_UNIQUE_CHARS + 2];
+    
+    // Equations whose last k digits become known before the whole equation:
+    // checked modulo 10^k, which holds for +, - and * alike
+    int modCheckConstraint[MAX_EXPR_CONSTRAINTS * (MAX_UNIQUE_CHARS + 1)];
+    int modCheckDigits[MAX_EXPR_CONSTRAINTS * (MAX_UNIQUE_CHARS + 1)];
+    int modCheckStart[MAX_UNIQUE_CHARS + 2];
+    
+    ExprValue value[MAX_EXPR_NODES];
+    bool tooLarge;                      // A value did not fit in ExprValue; the search was abandoned
+    
+    long long solutionCount;
+    long long nodesVisited;
+    bool verbose;
+} AlphameticSystem;
 
 // Function prototypes
 bool isConsistent(Puzzle *puzzle, int charIndex, int digit);
 bool solveAllSolutions(Puzzle *puzzle, int charIndex);
-int evaluateWord(Puzzle *puzzle, char *word);
-void findUniqueChars(Puzzle *puzzle);
+bool checkColumns(Puzzle *puzzle);
+void printWordValue(Puzzle *puzzle, char *word);
+bool findUniqueChars(Puzzle *puzzle);
 int getCharIndex(Puzzle *puzzle, char c);
 void printSolution(Puzzle *puzzle);
 void preComputeConstraints(Puzzle *puzzle);
-void analyzeLastDigits(Puzzle *puzzle);
+bool analyzeLastDigits(Puzzle *puzzle);
+bool tightenColumnBounds(Puzzle *puzzle);
 void checkLeadingDigitConstraints(Puzzle *puzzle);
 void printConstraintAnalysis(Puzzle *puzzle);
+void buildColumns(Puzzle *puzzle);
+MemoTable *createMemoTable(Puzzle *puzzle, int entries);
+void freeMemoTable(MemoTable *table);
+bool solveByColumns(Puzzle *puzzle, int column, int row, int columnSum);
+void reportSolution(Puzzle *puzzle);
+void initPropagationState(Puzzle *puzzle, PropagationState *state);
+bool propagate(Puzzle *puzzle, PropagationState *state);
+void prepareBranchOrder(Puzzle *puzzle);
+bool solveWithPropagation(Puzzle *puzzle, PropagationState *state);
+bool compileEquation(Puzzle *puzzle);
+void prepareLinearPlan(Puzzle *puzzle, LinearPlan *plan);
+bool solveLinear(Puzzle *puzzle, const LinearPlan *plan, int depth, long long partialSum);
+long long solveLinearParallel(Puzzle *puzzle, const LinearPlan *plan, int numThreads);
+long long solveByPermutations(Puzzle *puzzle, long long fixedSum);
+void solveWithSat(Puzzle *puzzle);
+bool solveWithKernel(Puzzle *puzzle, const LinearPlan *plan);
+void solveMeetInTheMiddle(Puzzle *puzzle, const LinearPlan *plan);
+void initPuzzle(Puzzle *puzzle);
+bool parsePuzzleString(Puzzle *puzzle, const char *text, const char **error);
+bool preparePuzzle(Puzzle *puzzle);
+void runSolver(Puzzle *puzzle, SolverMode mode, int numThreads);
+void canonicalSignature(const Puzzle *puzzle, char *signature, int *canonicalLetter);
+int runBatch(const char *inputPath, const char *outputPath, const char *format, int numThreads, int base,
+             SolutionCache *cache);
+bool parseAlphameticSystem(AlphameticSystem *system, const char *text, const char **error);
+bool solveSystem(AlphameticSystem *system, int depth);
+int runExpression(const char *text);
+
+// Mark the search stopped once the caller has set the cancellation token.
+// Returns whether the search should stop.
+static inline bool pollCancel(Puzzle *puzzle) {
+    if (puzzle->cancel != NULL && atomic_load_explicit(puzzle->cancel, memory_order_relaxed)) {
+        puzzle->stopped = true;
+    }
+    return puzzle->stopped;
+}
+
+// Count a search node, looking at the cancellation token now and then
+static inline void countNode(Puzzle *puzzle) {
+    if ((++puzzle->nodes & (CANCEL_POLL_INTERVAL - 1)) == 0) {
+        pollCancel(puzzle);
+    }
+}
 
 // Check if assigning 'digit' to the character at 'charIndex' is consistent with constraints
 bool isConsistent(Puzzle *puzzle, int charIndex, int digit) {
@@ -50,7 +359,7 @@ bool isConsistent(Puzzle *puzzle, int charIndex, int digit) {
         return false;
     
     // Check pre-computed constraints - is this digit allowed for this character?
-    if (!puzzle->possibleDigits[charIndex][digit])
+    if (!(puzzle->domain[charIndex] & DIGIT_BIT(digit)))
         return false;
     
     // Check zero constraint
@@ -61,14 +370,35 @@ bool isConsistent(Puzzle *puzzle, int charIndex, int digit) {
     return true;
 }
 
-// Evaluate a word based on current assignments
-int evaluateWord(Puzzle *puzzle, char *word) {
-    int value = 0;
+// Check the current assignments column by column with carries, so the words
+// can be of any length without their values overflowing
+bool checkColumns(Puzzle *puzzle) {
+    int carry = 0;
+    for (int c = 0; c < puzzle->numColumns; c++) {
+        int sum = carry;
+        for (int t = 0; t < puzzle->columnTermCount[c]; t++) {
+            sum += puzzle->columnTermCoef[c][t] * puzzle->assigned[puzzle->columnTermLetter[c][t]];
+        }
+        if (sum < 0 || sum % puzzle->base != 0) {
+            return false;
+        }
+        carry = sum / puzzle->base;
+    }
+    return carry == 0;
+}
+
+// Print the value of a word as a numeral in the puzzle's base: digits 0-9A-Z
+// up to base 36, decimal digits separated by ':' above that
+void printWordValue(Puzzle *puzzle, char *word) {
+    static const char symbols[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
     for (int i = 0; word[i] != '\0'; i++) {
-        int idx = getCharIndex(puzzle, word[i]);
-        value = value * 10 + puzzle->assigned[idx];
+        int digit = puzzle->assigned[getCharIndex(puzzle, word[i])];
+        if (puzzle->base <= 36) {
+            putchar(symbols[digit]);
+        } else {
+            printf("%s%d", i > 0 ? ":" : "", digit);
+        }
     }
-    return value;
 }
 
 // Find the index of a character in the uniqueChars array
@@ -81,52 +411,49 @@ int getCharIndex(Puzzle *puzzle, char c) {
     return -1;
 }
 
-// Extract unique characters from the puzzle
-void findUniqueChars(Puzzle *puzzle) {
-    bool charExists[26] = {false};
+// Letters of a puzzle in the given base: A-Z (case-insensitive) up to base
+// 26; above that case matters and digits, '_' and '@' also count as letters,
+// which gives 64 symbols
+bool isPuzzleLetter(int base, char c) {
+    if (base <= 26) {
+        return isalpha((unsigned char)c);
+    }
+    return isalnum((unsigned char)c) || c == '_' || c == '@';
+}
+
+char normalizeLetter(int base, char c) {
+    return base <= 26 ? toupper((unsigned char)c) : c;
+}
+
+// Extract unique characters from the puzzle.
+// Returns false if there are more than MAX_UNIQUE_CHARS of them or more than
+// the base has digits.
+bool findUniqueChars(Puzzle *puzzle) {
+    bool charExists[256] = {false};
     int uniqueCount = 0;
     
     // Process all words including the result
-    for (int w = 0; w < puzzle->numWords; w++) {
-        for (int i = 0; puzzle->words[w][i] != '\0'; i++) {
-            char c = puzzle->words[w][i];
-            if (isalpha(c)) {
-                c = toupper(c);
-                int idx = c - 'A';
+    for (int w = 0; w <= puzzle->numWords; w++) {
+        char *word = (w < puzzle->numWords) ? puzzle->words[w] : puzzle->result;
+        for (int i = 0; word[i] != '\0'; i++) {
+            char c = word[i];
+            if (isPuzzleLetter(puzzle->base, c)) {
+                c = normalizeLetter(puzzle->base, c);
+                int idx = (unsigned char)c;
                 if (!charExists[idx]) {
-                    charExists[idx] = true;
-                    puzzle->uniqueChars[uniqueCount++] = c;
-                    
                     // Check if we have too many unique characters
-                    if (uniqueCount > MAX_UNIQUE_CHARS) {
-                        printf("Error: Too many unique characters (max is 10)\n");
-                        exit(1);
+                    if (uniqueCount >= MAX_UNIQUE_CHARS || uniqueCount >= puzzle->base) {
+                        return false;
                     }
-                }
-            }
-        }
-    }
-    
-    // Process the result word
-    for (int i = 0; puzzle->result[i] != '\0'; i++) {
-        char c = puzzle->result[i];
-        if (isalpha(c)) {
-            c = toupper(c);
-            int idx = c - 'A';
-            if (!charExists[idx]) {
-                charExists[idx] = true;
-                puzzle->uniqueChars[uniqueCount++] = c;
-                
-                // Check if we have too many unique characters
-                if (uniqueCount > MAX_UNIQUE_CHARS) {
-                    printf("Error: Too many unique characters (max is 10)\n");
-                    exit(1);
+                    charExists[idx] = true;
+                    puzzle->uniqueChars[uniqueCount++] = c;
                 }
             }
         }
     }
     
     puzzle->numUniqueChars = uniqueCount;
+    return true;
 }
 
 // Pre-compute constraints to narrow down the search space
@@ -138,36 +465,35 @@ void preComputeConstraints(Puzzle *puzzle) {
         puzzle->assigned[i] = -1; // Unassigned
         
         // All digits are possible initially
-        for (int d = 0; d <= 9; d++) {
-            puzzle->possibleDigits[i][d] = true;
-        }
+        puzzle->domain[i] = allDigits(puzzle->base);
     }
     
     // Check which characters cannot be zero (leading digits)
     checkLeadingDigitConstraints(puzzle);
     
-    // Analyze last digits for constraints
-    analyzeLastDigits(puzzle);
+    // Both analyses below work on the column model
+    buildColumns(puzzle);
+    
+    // Alternate modular pruning from the last digits with bounds reasoning
+    // from the leading columns until neither removes a digit
+    bool changed = true;
+    while (changed) {
+        changed = analyzeLastDigits(puzzle);
+        changed = tightenColumnBounds(puzzle) || changed;
+    }
     
     // Look for any characters that can only be one specific digit
     for (int i = 0; i < puzzle->numUniqueChars; i++) {
-        int possibleCount = 0;
-        int lastPossibleDigit = -1;
-        
-        for (int d = 0; d <= 9; d++) {
-            if (puzzle->possibleDigits[i][d]) {
-                possibleCount++;
-                lastPossibleDigit = d;
-            }
-        }
-        
         // If only one possibility exists, mark as fixed
-        if (possibleCount == 1 && lastPossibleDigit != -1) {
+        if (__builtin_popcountll(puzzle->domain[i]) == 1) {
+            int lastPossibleDigit = __builtin_ctzll(puzzle->domain[i]);
             puzzle->fixedAssignment[i] = true;
             puzzle->assigned[i] = lastPossibleDigit;
             puzzle->used[lastPossibleDigit] = true;
-            printf("Pre-assigned: %c = %d (fixed by constraint analysis)\n", 
-                   puzzle->uniqueChars[i], lastPossibleDigit);
+            if (puzzle->verbose) {
+                printf("Pre-assigned: %c = %d (fixed by constraint analysis)\n", 
+                       puzzle->uniqueChars[i], lastPossibleDigit);
+            }
         }
     }
 }
@@ -179,70 +505,140 @@ void checkLeadingDigitConstraints(Puzzle *puzzle) {
         char firstChar = puzzle->words[i][0];
         int idx = getCharIndex(puzzle, firstChar);
         puzzle->canBeZero[idx] = false;
-        puzzle->possibleDigits[idx][0] = false;
+        puzzle->domain[idx] &= ~DIGIT_BIT(0);
     }
     
     // First letter of result cannot be assigned zero
     char resultFirstChar = puzzle->result[0];
     int resultIdx = getCharIndex(puzzle, resultFirstChar);
     puzzle->canBeZero[resultIdx] = false;
-    puzzle->possibleDigits[resultIdx][0] = false;
+    puzzle->domain[resultIdx] &= ~DIGIT_BIT(0);
 }
 
-// Analyze last digits for possible constraints
-void analyzeLastDigits(Puzzle *puzzle) {
-    // Extract last digits
-    char inputLastDigits[MAX_WORDS];
-    char resultLastDigit;
-    
-    // Get result's last digit
-    int resultLen = strlen(puzzle->result);
-    if (resultLen > 0) {
-        resultLastDigit = puzzle->result[resultLen - 1];
-    } else {
-        return; // Can't analyze empty result
+// Enumerate the assignments to the letters of the lowest 'k' columns that
+// satisfy those columns with carry, and mark their digits in 'support'.
+// A column's last term is solved for directly when its coefficient is +-1.
+// Returns false once 'budget' nodes have been spent.
+static bool collectSuffixSupport(Puzzle *puzzle, int k, int column, int term, int sum, int *assigned,
+                                 DigitMask usedDigits, DigitMask *support, long long *budget) {
+    if (--*budget < 0) {
+        return false;
     }
     
-    // Get last digits of input words
-    int wordCount = 0;
-    for (int i = 0; i < puzzle->numWords; i++) {
-        int len = strlen(puzzle->words[i]);
-        if (len > 0) {
-            inputLastDigits[wordCount++] = puzzle->words[i][len - 1];
+    int count = puzzle->columnTermCount[column];
+    if (term == count) {
+        if (sum < 0 || sum % puzzle->base != 0) {
+            return true;
+        }
+        if (column + 1 == k) {
+            for (int i = 0; i < puzzle->numUniqueChars; i++) {
+                if (assigned[i] >= 0) {
+                    support[i] |= DIGIT_BIT(assigned[i]);
+                }
+            }
+            return true;
         }
+        return collectSuffixSupport(puzzle, k, column + 1, 0, sum / puzzle->base, assigned, usedDigits,
+                                    support, budget);
     }
     
-    // If all last digits are the same character and match result's last digit
-    bool allSame = true;
-    for (int i = 1; i < wordCount; i++) {
-        if (inputLastDigits[i] != inputLastDigits[0]) {
-            allSame = false;
-            break;
+    int idx = puzzle->columnTermLetter[column][term];
+    int coef = puzzle->columnTermCoef[column][term];
+    if (assigned[idx] >= 0) {
+        return collectSuffixSupport(puzzle, k, column, term + 1, sum + coef * assigned[idx], assigned,
+                                    usedDigits, support, budget);
+    }
+    
+    DigitMask choices = puzzle->domain[idx] & ~usedDigits;
+    if (term + 1 == count && (coef == 1 || coef == -1)) {
+        choices &= DIGIT_BIT(((-coef * sum) % puzzle->base + puzzle->base) % puzzle->base);
+    }
+    bool complete = true;
+    while (choices != 0 && complete) {
+        int digit = __builtin_ctzll(choices);
+        choices &= choices - 1;
+        assigned[idx] = digit;
+        complete = collectSuffixSupport(puzzle, k, column, term + 1, sum + coef * digit, assigned,
+                                        usedDigits | DIGIT_BIT(digit), support, budget);
+    }
+    assigned[idx] = -1;
+    return complete;
+}
+
+// Modular pruning from the last digits: for k = 1, 2, ... the digit tuples
+// that satisfy the equation modulo base^k are enumerated, and each letter of
+// the last k columns keeps only the digits that occur in one of them. Stops
+// at the first k that needs more than MODULAR_NODE_LIMIT nodes.
+// Returns true if any domain was narrowed.
+bool analyzeLastDigits(Puzzle *puzzle) {
+    bool narrowed = false;
+    for (int i = 0; i < puzzle->numUniqueChars; i++) {
+        if (puzzle->domain[i] == 0) {
+            return false;
         }
     }
     
-    if (allSame && wordCount > 0) {
-        char commonChar = inputLastDigits[0];
+    for (int k = 1; k < puzzle->numColumns; k++) {
+        DigitMask support[MAX_UNIQUE_CHARS] = {0};
+        int assigned[MAX_UNIQUE_CHARS];
+        bool inSuffix[MAX_UNIQUE_CHARS] = {false};
+        long long budget = MODULAR_NODE_LIMIT;
+        for (int i = 0; i < puzzle->numUniqueChars; i++) {
+            assigned[i] = -1;
+        }
+        if (!collectSuffixSupport(puzzle, k, 0, 0, 0, assigned, 0, support, &budget)) {
+            break;
+        }
         
-        // If last digits of inputs and result are the same character
-        if (commonChar == resultLastDigit) {
-            int idx = getCharIndex(puzzle, commonChar);
-            // This character can only be 0
-            for (int d = 1; d <= 9; d++) {
-                puzzle->possibleDigits[idx][d] = false;
+        int removed = 0;
+        for (int c = 0; c < k; c++) {
+            for (int t = 0; t < puzzle->columnTermCount[c]; t++) {
+                inSuffix[puzzle->columnTermLetter[c][t]] = true;
             }
-            printf("Constraint: %c must be 0 (all last digits)\n", commonChar);
         }
-        
-        // If last digits of inputs differ from result
-        else {
-            // More complex logic here - could be 0 or 5 depending on count
-            // For simplicity, we'll skip detailed analysis here
+        for (int i = 0; i < puzzle->numUniqueChars; i++) {
+            if (inSuffix[i] && (puzzle->domain[i] & ~support[i]) != 0) {
+                removed += __builtin_popcountll(puzzle->domain[i] & ~support[i]);
+                puzzle->domain[i] &= support[i];
+                narrowed = true;
+            }
+        }
+        if (removed > 0 && puzzle->verbose) {
+            printf("Constraint: last %d column(s) modulo %d^%d rule out %d digit(s)\n", k, puzzle->base, k, removed);
+        }
+        if (support[puzzle->columnTermLetter[0][0]] == 0) {
+            break; // No tuple satisfies even the last k columns
+        }
+    }
+    return narrowed;
+}
+
+// Bounds reasoning over all columns before search. The carry out of the top
+// column is zero, which caps the leading digits of the result (M = 1 in
+// SEND+MORE=MONEY). Returns true if any domain was narrowed.
+bool tightenColumnBounds(Puzzle *puzzle) {
+    for (int i = 0; i < puzzle->numUniqueChars; i++) {
+        if (puzzle->domain[i] == 0) {
+            return false;
         }
     }
     
-    // Advanced sum constraint analysis would go here
-    // This would involve modular arithmetic to limit possible values
+    PropagationState *state = malloc(sizeof(PropagationState));
+    initPropagationState(puzzle, state);
+    bool feasible = propagate(puzzle, state);
+    bool narrowed = false;
+    for (int i = 0; i < puzzle->numUniqueChars; i++) {
+        DigitMask mask = feasible ? state->domain[i] : 0;
+        if (mask != puzzle->domain[i]) {
+            if (puzzle->verbose && __builtin_popcountll(mask) == 1) {
+                printf("Constraint: %c must be %d (column bounds)\n", puzzle->uniqueChars[i], __builtin_ctzll(mask));
+            }
+            puzzle->domain[i] = mask;
+            narrowed = true;
+        }
+    }
+    free(state);
+    return narrowed;
 }
 
 // Print constraint analysis for debugging
@@ -255,8 +651,8 @@ void printConstraintAnalysis(Puzzle *puzzle) {
         
         printf("Possible digits [");
         int possibleCount = 0;
-        for (int d = 0; d <= 9; d++) {
-            if (puzzle->possibleDigits[i][d]) {
+        for (int d = 0; d < puzzle->base; d++) {
+            if (puzzle->domain[i] & DIGIT_BIT(d)) {
                 printf("%d ", d);
                 possibleCount++;
             }
@@ -278,6 +674,8 @@ void printConstraintAnalysis(Puzzle *puzzle) {
 
 // Recursive backtracking solver to find all solutions
 bool solveAllSolutions(Puzzle *puzzle, int charIndex) {
+    countNode(puzzle);
+    
     // Skip characters that already have fixed assignments
     while (charIndex < puzzle->numUniqueChars && puzzle->fixedAssignment[charIndex]) {
         charIndex++;
@@ -286,26 +684,19 @@ bool solveAllSolutions(Puzzle *puzzle, int charIndex) {
     // Base case: all characters have been assigned
     if (charIndex >= puzzle->numUniqueChars) {
         // Check if the equation is satisfied
-        int sum = 0;
-        for (int i = 0; i < puzzle->numWords; i++) {
-            sum += evaluateWord(puzzle, puzzle->words[i]);
-        }
-        int result = evaluateWord(puzzle, puzzle->result);
-        
-        if (sum == result) {
+        if (checkColumns(puzzle)) {
             // Found a valid solution, print it
-            puzzle->solutionCount++;
-            printf("\nSolution #%d:\n", puzzle->solutionCount);
-            printSolution(puzzle);
+            reportSolution(puzzle);
             return true; // Continue searching for more solutions
         }
+        puzzle->prunes++;
         return false;
     }
     
     bool foundAnySolution = false;
     
     // Try each possible digit for the current character
-    for (int digit = 0; digit <= 9; digit++) {
+    for (int digit = 0; digit < puzzle->base && !puzzle->stopped; digit++) {
         if (isConsistent(puzzle, charIndex, digit)) {
             // Assign this digit and mark it as used
             puzzle->assigned[charIndex] = digit;
@@ -316,6 +707,8 @@ bool solveAllSolutions(Puzzle *puzzle, int charIndex) {
             if (found) {
                 foundAnySolution = true;
                 // Don't return here, continue to find all solutions
+            } else {
+                puzzle->backtracks++;
             }
             
             // Backtrack
@@ -331,90 +724,4394 @@ bool solveAllSolutions(Puzzle *puzzle, int charIndex) {
     return foundAnySolution;
 }
 
-// Print the solution
-void printSolution(Puzzle *puzzle) {
-    // Print the mapping
-    for (int i = 0; i < puzzle->numUniqueChars; i++) {
-        printf("%c = %d\n", puzzle->uniqueChars[i], puzzle->assigned[i]);
+// Build the column model used by the column-wise solver
+void buildColumns(Puzzle *puzzle) {
+    int resultLen = strlen(puzzle->result);
+    int maxLen = resultLen;
+    for (int w = 0; w < puzzle->numWords; w++) {
+        int len = strlen(puzzle->words[w]);
+        if (len > maxLen) {
+            maxLen = len;
+        }
     }
+    puzzle->numColumns = maxLen;
     
-    // Print the equation with values
-    printf("\nEquation:\n");
-    for (int i = 0; i < puzzle->numWords; i++) {
-        if (i > 0) {
-            printf("+ ");
+    for (int c = 0; c < maxLen; c++) {
+        puzzle->columnLetterCount[c] = 0;
+        for (int w = 0; w < puzzle->numWords; w++) {
+            int len = strlen(puzzle->words[w]);
+            if (c < len) {
+                int idx = getCharIndex(puzzle, puzzle->words[w][len - 1 - c]);
+                puzzle->columnLetters[c][puzzle->columnLetterCount[c]++] = idx;
+            }
+        }
+        puzzle->resultLetter[c] = (c < resultLen) ? getCharIndex(puzzle, puzzle->result[resultLen - 1 - c]) : -1;
+        
+        // Merge repeated letters into one term with a multiplicity
+        puzzle->columnTermCount[c] = 0;
+        for (int k = 0; k <= puzzle->columnLetterCount[c]; k++) {
+            int idx, coef;
+            if (k < puzzle->columnLetterCount[c]) {
+                idx = puzzle->columnLetters[c][k];
+                coef = 1;
+            } else if (puzzle->resultLetter[c] != -1) {
+                idx = puzzle->resultLetter[c];
+                coef = -1;
+            } else {
+                break;
+            }
+            
+            int t = 0;
+            while (t < puzzle->columnTermCount[c] && puzzle->columnTermLetter[c][t] != idx) {
+                t++;
+            }
+            if (t == puzzle->columnTermCount[c]) {
+                puzzle->columnTermLetter[c][t] = idx;
+                puzzle->columnTermCoef[c][t] = 0;
+                puzzle->columnTermCount[c]++;
+            }
+            puzzle->columnTermCoef[c][t] += coef;
         }
-        printf("%s (%d)\n", puzzle->words[i], evaluateWord(puzzle, puzzle->words[i]));
     }
-    printf("= %s (%d)\n", puzzle->result, evaluateWord(puzzle, puzzle->result));
 }
 
-int main() {
-    Puzzle puzzle;
-    
-    // Initialize
-    memset(puzzle.used, false, sizeof(puzzle.used));
-    puzzle.solutionCount = 0;
-    
-    // Get number of words from the user
-    printf("Enter the number of words in the equation (max %d): ", MAX_WORDS - 1);
-    scanf("%d", &puzzle.numWords);
-    
-    if (puzzle.numWords < 1 || puzzle.numWords >= MAX_WORDS) {
-        printf("Invalid number of words. Must be between 1 and %d.\n", MAX_WORDS - 1);
-        return 1;
+// Allocate a memo table that may grow to 'entries' states (rounded down to a
+// power of two) and find each column's boundary letters: those assigned in
+// earlier columns, or fixed, that appear again from this column on. The
+// table starts small so that short searches do not pay for a large one.
+MemoTable *createMemoTable(Puzzle *puzzle, int entries) {
+    MemoTable *table = malloc(sizeof(MemoTable));
+    table->maxBuckets = 1;
+    while (table->maxBuckets * 2 * MEMO_WAYS <= (size_t)entries) {
+        table->maxBuckets *= 2;
     }
+    table->numBuckets = table->maxBuckets < 256 ? table->maxBuckets : 256;
+    table->entries = calloc(table->numBuckets * MEMO_WAYS, sizeof(MemoEntry));
+    table->stores = 0;
     
-    // Get input words from the user
-    for (int i = 0; i < puzzle.numWords; i++) {
-        printf("Enter word %d: ", i + 1);
-        scanf("%s", puzzle.words[i]);
-        
-        // Convert to uppercase
-        for (int j = 0; puzzle.words[i][j]; j++) {
-            puzzle.words[i][j] = toupper(puzzle.words[i][j]);
+    int firstColumn[MAX_UNIQUE_CHARS], lastColumn[MAX_UNIQUE_CHARS];
+    for (int i = 0; i < puzzle->numUniqueChars; i++) {
+        firstColumn[i] = puzzle->fixedAssignment[i] ? -1 : MAX_LEN;
+        lastColumn[i] = -1;
+    }
+    for (int c = 0; c < puzzle->numColumns; c++) {
+        for (int k = 0; k <= puzzle->columnLetterCount[c]; k++) {
+            int idx = (k < puzzle->columnLetterCount[c]) ? puzzle->columnLetters[c][k] : puzzle->resultLetter[c];
+            if (idx == -1) {
+                continue;
+            }
+            if (c < firstColumn[idx]) {
+                firstColumn[idx] = c;
+            }
+            lastColumn[idx] = c;
+        }
+    }
+    for (int c = 0; c < puzzle->numColumns; c++) {
+        table->boundaryCount[c] = 0;
+        for (int i = 0; i < puzzle->numUniqueChars; i++) {
+            if (firstColumn[i] < c && lastColumn[i] >= c) {
+                table->boundary[c][table->boundaryCount[c]++] = i;
+            }
+        }
+    }
+    return table;
+}
+
+void freeMemoTable(MemoTable *table) {
+    free(table->entries);
+    free(table);
+}
+
+static uint64_t hashMemoState(const MemoEntry *state, int boundaryCount) {
+    uint64_t h = state->used ^ ((uint64_t)state->column << 40) ^ ((uint64_t)state->carry << 52);
+    for (int k = 0; k < boundaryCount; k++) {
+        h = (h ^ state->digits[k]) * 0x100000001B3ULL;
+    }
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    return h ^ (h >> 32);
+}
+
+static void makeMemoKey(Puzzle *puzzle, int column, int carry, MemoEntry *key, size_t *bucket) {
+    MemoTable *table = puzzle->memo;
+    memset(key, 0, sizeof(MemoEntry));
+    key->valid = true;
+    key->column = column;
+    key->carry = carry;
+    for (int d = 0; d < puzzle->base; d++) {
+        if (puzzle->used[d]) {
+            key->used |= DIGIT_BIT(d);
         }
     }
     
-    // Get the result word
-    printf("Enter the result word: ");
-    scanf("%s", puzzle.result);
+    for (int k = 0; k < table->boundaryCount[column]; k++) {
+        key->digits[k] = puzzle->assigned[table->boundary[column][k]];
+    }
+    *bucket = (size_t)(hashMemoState(key, table->boundaryCount[column]) & (table->numBuckets - 1));
+}
+
+static bool sameMemoState(const MemoEntry *a, const MemoEntry *b, int boundaryCount) {
+    return a->valid && a->column == b->column && a->carry == b->carry && a->used == b->used &&
+           memcmp(a->digits, b->digits, boundaryCount) == 0;
+}
+
+// Place a state in its bucket. A bucket keeps its MEMO_WAYS most expensive
+// states: the cheapest one is replaced when the bucket is full.
+static void placeMemo(MemoTable *table, size_t bucket, const MemoEntry *state) {
+    MemoEntry *slots = &table->entries[bucket * MEMO_WAYS];
+    MemoEntry *victim = &slots[0];
+    for (int w = 0; w < MEMO_WAYS; w++) {
+        if (!slots[w].valid) {
+            victim = &slots[w];
+            break;
+        }
+        if (slots[w].work < victim->work) {
+            victim = &slots[w];
+        }
+    }
+    *victim = *state;
+}
+
+// Record a finished state, doubling the table (up to maxBuckets) each time
+// it has taken as many stores as it has entries
+static void storeMemo(MemoTable *table, size_t bucket, const MemoEntry *state) {
+    table->stores++;
+    size_t capacity = table->numBuckets * MEMO_WAYS;
+    if (table->numBuckets < table->maxBuckets && table->stores % capacity == 0) {
+        MemoEntry *old = table->entries;
+        table->numBuckets *= 2;
+        table->entries = calloc(table->numBuckets * MEMO_WAYS, sizeof(MemoEntry));
+        for (size_t e = 0; e < capacity; e++) {
+            if (old[e].valid) {
+                uint64_t h = hashMemoState(&old[e], table->boundaryCount[old[e].column]);
+                placeMemo(table, (size_t)(h & (table->numBuckets - 1)), &old[e]);
+            }
+        }
+        free(old);
+        bucket = (size_t)(hashMemoState(state, table->boundaryCount[state->column]) & (table->numBuckets - 1));
+    }
+    placeMemo(table, bucket, state);
+}
+
+static bool extendColumns(Puzzle *puzzle, int column, int row, int columnSum);
+
+// Column-wise solver: works from the least significant column with an explicit
+// carry, assigning only the letters of the current column. 'row' walks the
+// letters of the input words in 'column'; 'columnSum' is the carry plus the
+// digits summed so far. A branch is dropped as soon as the column digit of the
+// result does not match.
+// At the start of each column the state is looked up in puzzle->memo: a
+// state known to have no solutions is skipped, and in count-only mode a
+// state with a known count adds that count without searching it again.
+bool solveByColumns(Puzzle *puzzle, int column, int row, int columnSum) {
+    if (puzzle->memo == NULL || row != 0 || column == 0 || column >= puzzle->numColumns) {
+        return extendColumns(puzzle, column, row, columnSum);
+    }
     
-    // Convert to uppercase
-    for (int i = 0; puzzle.result[i]; i++) {
-        puzzle.result[i] = toupper(puzzle.result[i]);
+    MemoEntry state;
+    size_t bucket;
+    makeMemoKey(puzzle, column, columnSum, &state, &bucket);
+    int boundaryCount = puzzle->memo->boundaryCount[column];
+    MemoEntry *slots = &puzzle->memo->entries[bucket * MEMO_WAYS];
+    for (int w = 0; w < MEMO_WAYS; w++) {
+        if (!sameMemoState(&slots[w], &state, boundaryCount)) {
+            continue;
+        }
+        if (slots[w].solutions == 0) {
+            puzzle->memoHits++;
+            puzzle->prunes++;
+            return false;
+        }
+        if (puzzle->countOnly && puzzle->maxSolutions == 0) {
+            puzzle->memoHits++;
+            puzzle->solutionCount += slots[w].solutions;
+            return true;
+        }
+        break;
     }
     
-    // Find unique characters
-    findUniqueChars(&puzzle);
+    long long solutionsBefore = puzzle->solutionCount;
+    long long nodesBefore = puzzle->nodes;
+    bool found = extendColumns(puzzle, column, row, columnSum);
+    if (!puzzle->stopped) {
+        state.solutions = puzzle->solutionCount - solutionsBefore;
+        state.work = puzzle->nodes - nodesBefore;
+        storeMemo(puzzle->memo, bucket, &state);
+    }
+    return found;
+}
+
+static bool extendColumns(Puzzle *puzzle, int column, int row, int columnSum) {
+    countNode(puzzle);
     
-    // Check if the problem is solvable
-    if (puzzle.numUniqueChars > 10) {
-        printf("Error: Too many unique characters. Maximum allowed is 10.\n");
-        return 1;
+    // All columns done: the final carry must be zero
+    if (column >= puzzle->numColumns) {
+        if (columnSum == 0) {
+            reportSolution(puzzle);
+            return true;
+        }
+        puzzle->prunes++;
+        return false;
     }
     
-    printf("Puzzle has %d unique characters: ", puzzle.numUniqueChars);
-    for (int i = 0; i < puzzle.numUniqueChars; i++) {
-        printf("%c ", puzzle.uniqueChars[i]);
+    // Add the next letter of this column
+    if (row < puzzle->columnLetterCount[column]) {
+        int idx = puzzle->columnLetters[column][row];
+        if (puzzle->assigned[idx] != -1) {
+            return solveByColumns(puzzle, column, row + 1, columnSum + puzzle->assigned[idx]);
+        }
+        
+        bool foundAnySolution = false;
+        for (int digit = 0; digit < puzzle->base && !puzzle->stopped; digit++) {
+            if (isConsistent(puzzle, idx, digit)) {
+                puzzle->assigned[idx] = digit;
+                puzzle->used[digit] = true;
+                
+                if (solveByColumns(puzzle, column, row + 1, columnSum + digit)) {
+                    foundAnySolution = true;
+                } else {
+                    puzzle->backtracks++;
+                }
+                
+                puzzle->used[digit] = false;
+                puzzle->assigned[idx] = -1;
+            }
+        }
+        return foundAnySolution;
     }
-    printf("\n");
     
-    // Pre-compute constraints before backtracking
-    printf("\nAnalyzing constraints...\n");
-    preComputeConstraints(&puzzle);
-    printConstraintAnalysis(&puzzle);
+    // Column complete: the result letter must match the column digit
+    int digit = (unsigned int)columnSum % puzzle->base;
+    int carry = (unsigned int)columnSum / puzzle->base;
+    int idx = puzzle->resultLetter[column];
     
-    printf("Starting backtracking with pre-computed constraints...\n");
+    if (idx == -1) {
+        // Result is shorter than an input word, so this column must be 0
+        if (digit != 0) {
+            puzzle->prunes++;
+            return false;
+        }
+        return solveByColumns(puzzle, column + 1, 0, carry);
+    }
     
-    // Solve the puzzle to find all solutions
-    bool solved = solveAllSolutions(&puzzle, 0);
+    if (puzzle->assigned[idx] != -1) {
+        if (puzzle->assigned[idx] != digit) {
+            puzzle->prunes++;
+            return false;
+        }
+        return solveByColumns(puzzle, column + 1, 0, carry);
+    }
     
-    if (puzzle.solutionCount > 0) {
-        printf("\nTotal solutions found: %d\n", puzzle.solutionCount);
-    } else {
-        printf("\nNo solution exists for this puzzle.\n");
+    if (!isConsistent(puzzle, idx, digit)) {
+        puzzle->prunes++;
+        return false;
     }
     
-    return 0;
-} 
\ No newline at end of file
+    puzzle->assigned[idx] = digit;
+    puzzle->used[digit] = true;
+    bool found = solveByColumns(puzzle, column + 1, 0, carry);
+    puzzle->used[digit] = false;
+    puzzle->assigned[idx] = -1;
+    return found;
+}
+
+// Floor and ceiling of a / b for any signs (b != 0)
+static int floorDiv(int a, int b) {
+    int q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0))) {
+        q--;
+    }
+    return q;
+}
+
+static int ceilDiv(int a, int b) {
+    int q = a / b;
+    if ((a % b != 0) && ((a < 0) == (b < 0))) {
+        q++;
+    }
+    return q;
+}
+
+// Digits lo..hi as a mask (empty when lo > hi)
+static DigitMask rangeMask(int lo, int hi) {
+    if (lo < 0) {
+        lo = 0;
+    }
+    if (hi > MAX_BASE - 1) {
+        hi = MAX_BASE - 1;
+    }
+    if (lo > hi) {
+        return 0;
+    }
+    return allDigits(hi + 1) & ~allDigits(lo);
+}
+
+static int minDigit(DigitMask mask) {
+    return __builtin_ctzll(mask);
+}
+
+static int maxDigit(DigitMask mask) {
+    return 63 - __builtin_clzll(mask);
+}
+
+static void trailPush(PropagationState *state, TrailKind kind, int index, long long oldValue) {
+    if (state->trailSize >= MAX_TRAIL) {
+        printf("Error: Propagation trail overflow\n");
+        exit(1);
+    }
+    state->trail[state->trailSize++] = (TrailEntry){kind, index, oldValue};
+}
+
+// Narrow a domain, recording the old value. Returns false if it becomes empty.
+static bool setDomain(PropagationState *state, int idx, DigitMask mask) {
+    if (mask != state->domain[idx]) {
+        trailPush(state, TRAIL_DOMAIN, idx, state->domain[idx]);
+        state->domain[idx] = mask;
+    }
+    return mask != 0;
+}
+
+static bool setCarryBounds(PropagationState *state, int column, int lo, int hi) {
+    if (lo > state->carryLo[column]) {
+        trailPush(state, TRAIL_CARRY_LO, column, state->carryLo[column]);
+        state->carryLo[column] = lo;
+    }
+    if (hi < state->carryHi[column]) {
+        trailPush(state, TRAIL_CARRY_HI, column, state->carryHi[column]);
+        state->carryHi[column] = hi;
+    }
+    return state->carryLo[column] <= state->carryHi[column];
+}
+
+// Undo every change made after the trail had 'mark' entries
+static void undoTrail(PropagationState *state, int mark) {
+    while (state->trailSize > mark) {
+        TrailEntry e = state->trail[--state->trailSize];
+        switch (e.kind) {
+            case TRAIL_DOMAIN:
+                state->domain[e.index] = (DigitMask)e.oldValue;
+                break;
+            case TRAIL_CARRY_LO:
+                state->carryLo[e.index] = e.oldValue;
+                break;
+            case TRAIL_CARRY_HI:
+                state->carryHi[e.index] = e.oldValue;
+                break;
+        }
+    }
+}
+
+// Start from the pre-computed domains; carries are bounded by the word count
+void initPropagationState(Puzzle *puzzle, PropagationState *state) {
+    for (int i = 0; i < puzzle->numUniqueChars; i++) {
+        state->domain[i] = puzzle->fixedAssignment[i] ? DIGIT_BIT(puzzle->assigned[i]) : puzzle->domain[i];
+    }
+    for (int c = 0; c <= puzzle->numColumns; c++) {
+        state->carryLo[c] = 0;
+        state->carryHi[c] = (c == 0 || c == puzzle->numColumns) ? 0 : puzzle->numWords;
+    }
+    state->trailSize = 0;
+}
+
+// All-different with Hall intervals: if k letters fit inside an interval of k
+// digits, no other letter may take those digits. Only intervals running from
+// some letter's smallest digit to some letter's largest digit can be tight,
+// so with the letters sorted by largest digit each lower end is one O(n)
+// sweep instead of trying all base^2 intervals.
+static bool propagateAllDifferent(Puzzle *puzzle, PropagationState *state, bool *changed) {
+    int n = puzzle->numUniqueChars;
+    int lo[MAX_UNIQUE_CHARS], hi[MAX_UNIQUE_CHARS], byHi[MAX_UNIQUE_CHARS];
+    for (int i = 0; i < n; i++) {
+        lo[i] = minDigit(state->domain[i]);
+        hi[i] = maxDigit(state->domain[i]);
+        int k = i - 1;
+        while (k >= 0 && hi[byHi[k]] > hi[i]) {
+            byHi[k + 1] = byHi[k];
+            k--;
+        }
+        byHi[k + 1] = i;
+    }
+    
+    for (int a = 0; a < n; a++) {
+        // Each distinct lower end once
+        bool seen = false;
+        for (int b = 0; b < a && !seen; b++) {
+            seen = lo[b] == lo[a];
+        }
+        if (seen) {
+            continue;
+        }
+        
+        int inside = 0;
+        for (int k = 0; k < n; k++) {
+            int i = byHi[k];
+            if (lo[i] >= lo[a]) {
+                inside++;
+            }
+            // Check once all letters with this upper end are counted
+            if (hi[i] < lo[a] || (k + 1 < n && hi[byHi[k + 1]] == hi[i])) {
+                continue;
+            }
+            int size = hi[i] - lo[a] + 1;
+            if (inside > size) {
+                return false;
+            }
+            if (inside == size) {
+                DigitMask interval = rangeMask(lo[a], hi[i]);
+                for (int j = 0; j < n; j++) {
+                    if ((state->domain[j] & ~interval) != 0 && (state->domain[j] & interval) != 0) {
+                        if (!setDomain(state, j, state->domain[j] & ~interval)) {
+                            return false;
+                        }
+                        *changed = true;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Bounds reasoning on one column equation:
+// sum(coef * letter) + carry[c] - base * carry[c + 1] = 0
+static bool propagateColumn(Puzzle *puzzle, PropagationState *state, int c, bool *changed) {
+    int count = puzzle->columnTermCount[c];
+    int termMin[MAX_WORDS + 3], termMax[MAX_WORDS + 3];
+    int totalMin = 0, totalMax = 0;
+    
+    for (int t = 0; t < count; t++) {
+        int coef = puzzle->columnTermCoef[c][t];
+        DigitMask mask = state->domain[puzzle->columnTermLetter[c][t]];
+        int a = coef * minDigit(mask);
+        int b = coef * maxDigit(mask);
+        termMin[t] = a < b ? a : b;
+        termMax[t] = a < b ? b : a;
+    }
+    termMin[count] = state->carryLo[c];
+    termMax[count] = state->carryHi[c];
+    termMin[count + 1] = -puzzle->base * state->carryHi[c + 1];
+    termMax[count + 1] = -puzzle->base * state->carryLo[c + 1];
+    
+    for (int t = 0; t < count + 2; t++) {
+        totalMin += termMin[t];
+        totalMax += termMax[t];
+    }
+    if (totalMin > 0 || totalMax < 0) {
+        return false;
+    }
+    
+    // Each term must lie in [-(max of the others), -(min of the others)]
+    for (int t = 0; t < count + 2; t++) {
+        int lo = -(totalMax - termMax[t]);
+        int hi = -(totalMin - termMin[t]);
+        
+        if (t < count) {
+            int coef = puzzle->columnTermCoef[c][t];
+            if (coef == 0) {
+                continue;
+            }
+            int idx = puzzle->columnTermLetter[c][t];
+            int xLo = coef > 0 ? ceilDiv(lo, coef) : ceilDiv(hi, coef);
+            int xHi = coef > 0 ? floorDiv(hi, coef) : floorDiv(lo, coef);
+            DigitMask narrowed = state->domain[idx] & rangeMask(xLo, xHi);
+            if (narrowed != state->domain[idx]) {
+                if (!setDomain(state, idx, narrowed)) {
+                    return false;
+                }
+                *changed = true;
+            }
+        } else {
+            int column = (t == count) ? c : c + 1;
+            int cLo = (t == count) ? lo : ceilDiv(hi, -puzzle->base);
+            int cHi = (t == count) ? hi : floorDiv(lo, -puzzle->base);
+            if (cLo > state->carryLo[column] || cHi < state->carryHi[column]) {
+                if (!setCarryBounds(state, column, cLo, cHi)) {
+                    return false;
+                }
+                *changed = true;
+            }
+        }
+    }
+    return true;
+}
+
+// Run all-different and column propagation to a fixpoint
+bool propagate(Puzzle *puzzle, PropagationState *state) {
+    // The pre-analysis may leave a domain empty when there is no solution
+    for (int i = 0; i < puzzle->numUniqueChars; i++) {
+        if (state->domain[i] == 0) {
+            return false;
+        }
+    }
+    
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        if (!propagateAllDifferent(puzzle, state, &changed)) {
+            return false;
+        }
+        for (int c = 0; c < puzzle->numColumns; c++) {
+            if (!propagateColumn(puzzle, state, c, &changed)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Fill branchOrder for puzzle->variableOrder. ORDER_MRV breaks ties in
+// appearance order. Coefficients are summed in floating point: only their
+// magnitudes are compared, and words of any length fit.
+void prepareBranchOrder(Puzzle *puzzle) {
+    int n = puzzle->numUniqueChars;
+    double key[MAX_UNIQUE_CHARS];
+    for (int i = 0; i < n; i++) {
+        key[i] = 0;
+    }
+    
+    if (puzzle->variableOrder == ORDER_COLUMN) {
+        for (int i = 0; i < n; i++) {
+            key[i] = puzzle->numColumns;
+        }
+        for (int c = puzzle->numColumns - 1; c >= 0; c--) {
+            for (int t = 0; t < puzzle->columnTermCount[c]; t++) {
+                key[puzzle->columnTermLetter[c][t]] = c;
+            }
+        }
+    } else if (puzzle->variableOrder == ORDER_COEFFICIENT) {
+        double coef[MAX_UNIQUE_CHARS] = {0};
+        double place = 1;
+        for (int c = 0; c < puzzle->numColumns; c++) {
+            for (int t = 0; t < puzzle->columnTermCount[c]; t++) {
+                coef[puzzle->columnTermLetter[c][t]] += puzzle->columnTermCoef[c][t] * place;
+            }
+            place *= puzzle->base;
+        }
+        for (int i = 0; i < n; i++) {
+            key[i] = -fabs(coef[i]);
+        }
+    }
+    
+    // Stable insertion sort by ascending key
+    for (int i = 0; i < n; i++) {
+        int k = i - 1;
+        while (k >= 0 && key[puzzle->branchOrder[k]] > key[i]) {
+            puzzle->branchOrder[k + 1] = puzzle->branchOrder[k];
+            k--;
+        }
+        puzzle->branchOrder[k + 1] = i;
+    }
+}
+
+// Propagation solver: branch on a letter, then narrow every domain and carry
+// before going deeper. Once all domains are singletons the propagation has
+// already checked every column exactly.
+bool solveWithPropagation(Puzzle *puzzle, PropagationState *state) {
+    countNode(puzzle);
+    
+    int var = -1;
+    int smallest = MAX_BASE + 1;
+    for (int k = 0; k < puzzle->numUniqueChars; k++) {
+        int i = puzzle->branchOrder[k];
+        int size = __builtin_popcountll(state->domain[i]);
+        if (size > 1 && size < smallest) {
+            var = i;
+            smallest = size;
+            if (puzzle->variableOrder != ORDER_MRV) {
+                break;
+            }
+        }
+    }
+    
+    if (var == -1) {
+        for (int i = 0; i < puzzle->numUniqueChars; i++) {
+            puzzle->assigned[i] = minDigit(state->domain[i]);
+        }
+        reportSolution(puzzle);
+        return true;
+    }
+    
+    bool foundAnySolution = false;
+    DigitMask choices = state->domain[var];
+    while (choices && !puzzle->stopped) {
+        int digit = minDigit(choices);
+        choices &= choices - 1;
+        
+        int mark = state->trailSize;
+        if (setDomain(state, var, DIGIT_BIT(digit)) && propagate(puzzle, state)) {
+            if (solveWithPropagation(puzzle, state)) {
+                foundAnySolution = true;
+            } else {
+                puzzle->backtracks++;
+            }
+        } else {
+            puzzle->prunes++;
+        }
+        undoTrail(state, mark);
+    }
+    return foundAnySolution;
+}
+
+// Compile the puzzle into sum(letterCoef[i] * digit_i) = 0: a letter at
+// position p from the right of an input word adds base^p, in the result it
+// subtracts base^p. Returns false if a coefficient, or a partial sum the
+// solvers may form from them, would overflow.
+bool compileEquation(Puzzle *puzzle) {
+    for (int i = 0; i < puzzle->numUniqueChars; i++) {
+        puzzle->letterCoef[i] = 0;
+    }
+    
+    for (int w = 0; w <= puzzle->numWords; w++) {
+        char *word = (w < puzzle->numWords) ? puzzle->words[w] : puzzle->result;
+        long long sign = (w < puzzle->numWords) ? 1 : -1;
+        long long place = 1;
+        for (int i = strlen(word) - 1; i >= 0; i--) {
+            int idx = getCharIndex(puzzle, word[i]);
+            if (__builtin_add_overflow(puzzle->letterCoef[idx], sign * place, &puzzle->letterCoef[idx])) {
+                return false;
+            }
+            if (i > 0 && __builtin_mul_overflow(place, puzzle->base, &place)) {
+                return false;
+            }
+        }
+    }
+    
+    long long bound = 0;
+    for (int i = 0; i < puzzle->numUniqueChars; i++) {
+        long long term;
+        if (__builtin_mul_overflow(puzzle->letterCoef[i], puzzle->base - 1, &term) ||
+            __builtin_add_overflow(bound, term < 0 ? -term : term, &bound)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static long long absValue(long long v) {
+    return v < 0 ? -v : v;
+}
+
+// Order the free letters by decreasing |coefficient| so the bounds tighten
+// quickly, and precompute what each suffix of that order can still add
+void prepareLinearPlan(Puzzle *puzzle, LinearPlan *plan) {
+    plan->numFree = 0;
+    plan->fixedSum = 0;
+    for (int i = 0; i < puzzle->numUniqueChars; i++) {
+        if (puzzle->fixedAssignment[i]) {
+            plan->fixedSum += puzzle->letterCoef[i] * puzzle->assigned[i];
+        } else {
+            plan->order[plan->numFree++] = i;
+        }
+    }
+    
+    for (int a = 1; a < plan->numFree; a++) {
+        int idx = plan->order[a];
+        int b = a - 1;
+        while (b >= 0 && absValue(puzzle->letterCoef[plan->order[b]]) < absValue(puzzle->letterCoef[idx])) {
+            plan->order[b + 1] = plan->order[b];
+            b--;
+        }
+        plan->order[b + 1] = idx;
+    }
+    
+    plan->suffixMin[plan->numFree] = 0;
+    plan->suffixMax[plan->numFree] = 0;
+    for (int k = plan->numFree - 1; k >= 0; k--) {
+        int idx = plan->order[k];
+        long long lo = puzzle->letterCoef[idx] * minDigit(puzzle->domain[idx]);
+        long long hi = puzzle->letterCoef[idx] * maxDigit(puzzle->domain[idx]);
+        if (lo > hi) {
+            long long tmp = lo;
+            lo = hi;
+            hi = tmp;
+        }
+        plan->suffixMin[k] = plan->suffixMin[k + 1] + lo;
+        plan->suffixMax[k] = plan->suffixMax[k + 1] + hi;
+    }
+}
+
+// Linear-equation solver: keeps the running sum of the assigned letters and
+// drops a branch once zero is outside what the remaining letters can add.
+// No strings are touched during the search.
+bool solveLinear(Puzzle *puzzle, const LinearPlan *plan, int depth, long long partialSum) {
+    countNode(puzzle);
+    
+    if (depth == plan->numFree) {
+        if (partialSum == 0) {
+            reportSolution(puzzle);
+            return true;
+        }
+        return false;
+    }
+    
+    int idx = plan->order[depth];
+    long long coef = puzzle->letterCoef[idx];
+    long long restMin = plan->suffixMin[depth + 1];
+    long long restMax = plan->suffixMax[depth + 1];
+    bool foundAnySolution = false;
+    
+    DigitMask choices = puzzle->domain[idx];
+    while (choices && !puzzle->stopped) {
+        int digit = minDigit(choices);
+        choices &= choices - 1;
+        if (puzzle->used[digit]) {
+            continue;
+        }
+        
+        long long sum = partialSum + coef * digit;
+        if (sum + restMin > 0 || sum + restMax < 0) {
+            puzzle->prunes++;
+            continue;
+        }
+        
+        puzzle->assigned[idx] = digit;
+        puzzle->used[digit] = true;
+        if (solveLinear(puzzle, plan, depth + 1, sum)) {
+            foundAnySolution = true;
+        } else {
+            puzzle->backtracks++;
+        }
+        puzzle->used[digit] = false;
+        puzzle->assigned[idx] = -1;
+    }
+    return foundAnySolution;
+}
+
+// Enumerate the prefixes of the plan order down to 'splitDepth' that survive
+// the partial-sum bounds; each one becomes a task. Tasks come out in the
+// same order as the sequential search visits them.
+static void collectTasks(Puzzle *puzzle, const LinearPlan *plan, int depth, int splitDepth,
+                         long long partialSum, unsigned char *prefix, SearchTask **tasks,
+                         int *count, int *capacity) {
+    if (depth == splitDepth) {
+        if (*count == *capacity) {
+            *capacity = *capacity > 0 ? *capacity * 2 : 256;
+            *tasks = realloc(*tasks, *capacity * sizeof(SearchTask));
+        }
+        SearchTask *task = &(*tasks)[(*count)++];
+        memset(task, 0, sizeof(SearchTask));
+        task->depth = depth;
+        memcpy(task->prefix, prefix, depth);
+        task->partialSum = partialSum;
+        return;
+    }
+    
+    int idx = plan->order[depth];
+    DigitMask choices = puzzle->domain[idx];
+    while (choices) {
+        int digit = minDigit(choices);
+        choices &= choices - 1;
+        if (puzzle->used[digit]) {
+            continue;
+        }
+        long long sum = partialSum + puzzle->letterCoef[idx] * digit;
+        if (sum + plan->suffixMin[depth + 1] > 0 || sum + plan->suffixMax[depth + 1] < 0) {
+            continue;
+        }
+        prefix[depth] = digit;
+        puzzle->used[digit] = true;
+        collectTasks(puzzle, plan, depth + 1, splitDepth, sum, prefix, tasks, count, capacity);
+        puzzle->used[digit] = false;
+    }
+}
+
+static bool popTask(TaskDeque *deque, int *task) {
+    bool found = false;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->bottom > deque->top) {
+        *task = deque->items[--deque->bottom];
+        found = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static bool stealTask(TaskDeque *deque, int *task) {
+    bool found = false;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->bottom > deque->top) {
+        *task = deque->items[deque->top++];
+        found = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static void countSolution(Puzzle *puzzle, void *context);
+
+// Keep each solution of the running task in the task's own list
+static void collectSolution(Puzzle *puzzle, void *context) {
+    WorkerContext *worker = context;
+    SolutionList *list = &worker->current->solutions;
+    int n = puzzle->numUniqueChars;
+    
+    if (puzzle->countOnly && worker->search->base->onSolution == countSolution) {
+        // Only the count matters and no handler reads the digits, so there
+        // is nothing to replay later
+        list->countedOnly++;
+    } else {
+        if (list->count == list->capacity) {
+            list->capacity = list->capacity > 0 ? list->capacity * 2 : 4;
+            list->digits = realloc(list->digits, (size_t)list->capacity * n);
+        }
+        for (int i = 0; i < n; i++) {
+            list->digits[(size_t)list->count * n + i] = puzzle->assigned[i];
+        }
+        list->count++;
+    }
+    atomic_fetch_add(&worker->search->solutionCount, 1);
+    
+    // A task never needs more than maxSolutions of its own, and a task after
+    // the cutoff is not reported at all
+    int index = (int)(worker->current - worker->search->tasks);
+    if (puzzle->maxSolutions > 0 &&
+        (list->count + list->countedOnly >= puzzle->maxSolutions || index > atomic_load(&worker->search->cutoff))) {
+        puzzle->stopped = true;
+    }
+}
+
+// Record a finished task and move the cutoff to the first task at which the
+// solutions of all tasks up to it reach maxSolutions
+static void finishTask(ParallelSearch *search, SearchTask *task, long maxSolutions) {
+    pthread_mutex_lock(&search->limitLock);
+    task->done = true;
+    while (atomic_load(&search->cutoff) == search->numTasks && search->scanned < search->numTasks &&
+           search->tasks[search->scanned].done) {
+        SolutionList *list = &search->tasks[search->scanned].solutions;
+        search->prefixTotal += list->count + list->countedOnly;
+        if (search->prefixTotal >= maxSolutions) {
+            atomic_store(&search->cutoff, search->scanned);
+            break;
+        }
+        search->scanned++;
+    }
+    pthread_mutex_unlock(&search->limitLock);
+}
+
+static void *parallelWorker(void *arg) {
+    WorkerContext *worker = arg;
+    ParallelSearch *search = worker->search;
+    const LinearPlan *plan = search->plan;
+    
+    // Private copy of the assignment state
+    Puzzle *local = malloc(sizeof(Puzzle));
+    
+    while (!atomic_load(&search->stop)) {
+        int taskIndex;
+        if (!popTask(&search->deques[worker->id], &taskIndex)) {
+            bool stolen = false;
+            for (int k = 1; k < search->numWorkers && !stolen; k++) {
+                int victim = (worker->id + k) % search->numWorkers;
+                stolen = stealTask(&search->deques[victim], &taskIndex);
+            }
+            if (!stolen) {
+                break; // Tasks are never added, so empty deques mean we are done
+            }
+            atomic_fetch_add(&search->steals, 1);
+        }
+        
+        if (taskIndex > atomic_load(&search->cutoff)) {
+            continue; // Its solutions would come after the last one reported
+        }
+        SearchTask *task = &search->tasks[taskIndex];
+        memcpy(local, search->base, sizeof(Puzzle));
+        local->onSolution = collectSolution;
+        local->solutionContext = worker;
+        for (int k = 0; k < task->depth; k++) {
+            local->assigned[plan->order[k]] = task->prefix[k];
+            local->used[task->prefix[k]] = true;
+        }
+        worker->current = task;
+        local->nodes = 0;
+        local->prunes = 0;
+        local->backtracks = 0;
+        solveLinear(local, plan, task->depth, task->partialSum);
+        if (local->cancel != NULL && atomic_load(local->cancel)) {
+            atomic_store(&search->stop, true);
+        } else if (local->maxSolutions > 0 && taskIndex <= atomic_load(&search->cutoff)) {
+            finishTask(search, task, local->maxSolutions);
+        }
+        atomic_fetch_add(&search->nodes, local->nodes);
+        atomic_fetch_add(&search->prunes, local->prunes);
+        atomic_fetch_add(&search->backtracks, local->backtracks);
+    }
+    
+    free(local);
+    return NULL;
+}
+
+// Split the linear search at a shallow depth and run the subtrees on a
+// work-stealing pool. Every task works on a private copy of the puzzle;
+// solutions are reported afterwards in task order, so the output matches
+// the sequential solver. Returns the number of solutions.
+long long solveLinearParallel(Puzzle *puzzle, const LinearPlan *plan, int numThreads) {
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+    if (numThreads > MAX_THREADS) {
+        numThreads = MAX_THREADS;
+    }
+    
+    // Go deeper until there are enough tasks to balance the load
+    SearchTask *tasks = NULL;
+    int numTasks = 0, capacity = 0;
+    unsigned char prefix[MAX_UNIQUE_CHARS];
+    for (int splitDepth = 0; splitDepth <= plan->numFree; splitDepth++) {
+        for (int t = 0; t < numTasks; t++) {
+            free(tasks[t].solutions.digits);
+        }
+        numTasks = 0;
+        collectTasks(puzzle, plan, 0, splitDepth, plan->fixedSum, prefix, &tasks, &numTasks, &capacity);
+        if (numTasks >= numThreads * TASKS_PER_THREAD || numTasks == 0) {
+            break;
+        }
+    }
+    
+    ParallelSearch search;
+    search.base = puzzle;
+    search.plan = plan;
+    search.tasks = tasks;
+    search.numTasks = numTasks;
+    search.numWorkers = numThreads;
+    atomic_init(&search.solutionCount, 0);
+    atomic_init(&search.steals, 0);
+    atomic_init(&search.nodes, 0);
+    atomic_init(&search.prunes, 0);
+    atomic_init(&search.backtracks, 0);
+    atomic_init(&search.stop, false);
+    atomic_init(&search.cutoff, numTasks);
+    search.scanned = 0;
+    search.prefixTotal = 0;
+    pthread_mutex_init(&search.limitLock, NULL);
+    search.deques = malloc(numThreads * sizeof(TaskDeque));
+    
+    // Deal out contiguous blocks; the owner starts at the front of its block
+    for (int w = 0; w < numThreads; w++) {
+        int first = (int)((long)numTasks * w / numThreads);
+        int last = (int)((long)numTasks * (w + 1) / numThreads);
+        TaskDeque *deque = &search.deques[w];
+        deque->items = malloc((last - first + 1) * sizeof(int));
+        deque->top = 0;
+        deque->bottom = 0;
+        for (int t = last - 1; t >= first; t--) {
+            deque->items[deque->bottom++] = t;
+        }
+        pthread_mutex_init(&deque->lock, NULL);
+    }
+    
+    pthread_t threads[MAX_THREADS];
+    WorkerContext workers[MAX_THREADS];
+    for (int w = 0; w < numThreads; w++) {
+        workers[w] = (WorkerContext){&search, w, NULL};
+        pthread_create(&threads[w], NULL, parallelWorker, &workers[w]);
+    }
+    for (int w = 0; w < numThreads; w++) {
+        pthread_join(threads[w], NULL);
+    }
+    
+    // Merge in task order; nothing is reported after a cancellation
+    pollCancel(puzzle);
+    for (int t = 0; t < numTasks; t++) {
+        SolutionList *list = &tasks[t].solutions;
+        if (list->countedOnly > 0 && !pollCancel(puzzle)) {
+            long long counted = list->countedOnly;
+            if (puzzle->maxSolutions > 0 && puzzle->maxSolutions - puzzle->solutionCount <= counted) {
+                counted = puzzle->maxSolutions - puzzle->solutionCount;
+                puzzle->stopped = true;
+            }
+            puzzle->solutionCount += counted;
+        }
+        for (long long s = 0; s < list->count && !pollCancel(puzzle); s++) {
+            for (int i = 0; i < puzzle->numUniqueChars; i++) {
+                puzzle->assigned[i] = list->digits[(size_t)s * puzzle->numUniqueChars + i];
+            }
+            reportSolution(puzzle);
+        }
+        free(list->digits);
+    }
+    
+    puzzle->nodes += atomic_load(&search.nodes);
+    puzzle->prunes += atomic_load(&search.prunes);
+    puzzle->backtracks += atomic_load(&search.backtracks);
+    if (puzzle->verbose) {
+        printf("\nParallel search: %d threads, %d tasks, %ld steals\n",
+               numThreads, numTasks, (long)atomic_load(&search.steals));
+    }
+    
+    for (int w = 0; w < numThreads; w++) {
+        free(search.deques[w].items);
+        pthread_mutex_destroy(&search.deques[w].lock);
+    }
+    free(search.deques);
+    pthread_mutex_destroy(&search.limitLock);
+    free(tasks);
+    return puzzle->solutionCount;
+}
+
+// Report every lane of a checked permutation whose sum and filter both hit
+static void reportLaneHits(Puzzle *puzzle, const int *letters, int n, const LaneVector *digits,
+                           const LaneVector *hits) {
+    LaneVector hit = *hits;
+    for (int lane = 0; lane < PERMUTATION_LANES && !puzzle->stopped; lane++) {
+        if (hit[lane]) {
+            for (int pos = 0; pos < n; pos++) {
+                puzzle->assigned[letters[pos]] = (int)digits[pos][lane];
+            }
+            reportSolution(puzzle);
+        }
+    }
+}
+
+static bool anyLane(const LaneVector *v) {
+    long long any = 0;
+    for (int lane = 0; lane < PERMUTATION_LANES; lane++) {
+        any |= (*v)[lane];
+    }
+    return any != 0;
+}
+
+// Brute force for small puzzles. Every lane holds a different subset of the
+// free digits; all lanes walk the same Heap's-algorithm swap sequence, so each
+// step is one swap with O(1) updates of the weighted sum and of the count of
+// letters sitting on a digit outside their domain (leading zeros, pre-computed
+// constraints). A permutation is a solution when both are zero.
+// Returns the number of permutations checked.
+long long solveByPermutations(Puzzle *puzzle, long long fixedSum) {
+    int letters[MAX_UNIQUE_CHARS];
+    int freeDigits[MAX_BASE];
+    int n = 0, m = 0;
+    for (int i = 0; i < puzzle->numUniqueChars; i++) {
+        if (!puzzle->fixedAssignment[i]) {
+            letters[n++] = i;
+        }
+    }
+    for (int d = 0; d < puzzle->base; d++) {
+        if (!puzzle->used[d]) {
+            freeDigits[m++] = d;
+        }
+    }
+    if (n == 0) {
+        if (fixedSum == 0) {
+            reportSolution(puzzle);
+        }
+        return 1;
+    }
+    if (n > m) {
+        return 0;
+    }
+    
+    LaneVector coef[MAX_UNIQUE_CHARS];
+    LaneVector badMask[MAX_UNIQUE_CHARS];
+    for (int pos = 0; pos < n; pos++) {
+        for (int lane = 0; lane < PERMUTATION_LANES; lane++) {
+            coef[pos][lane] = puzzle->letterCoef[letters[pos]];
+            badMask[pos][lane] = (long long)(~puzzle->domain[letters[pos]] & allDigits(puzzle->base));
+        }
+    }
+    
+    int comb[MAX_BASE];
+    for (int k = 0; k < n; k++) {
+        comb[k] = k;
+    }
+    bool moreSubsets = true;
+    long long checked = 0;
+    
+    while (moreSubsets && !puzzle->stopped) {
+        // Load the next PERMUTATION_LANES digit subsets, one per lane
+        LaneVector digits[MAX_UNIQUE_CHARS];
+        LaneVector sum, bad;
+        int activeLanes = 0;
+        for (int lane = 0; lane < PERMUTATION_LANES; lane++) {
+            long long laneSum = fixedSum;
+            long long laneBad = 0;
+            for (int pos = 0; pos < n; pos++) {
+                int digit = moreSubsets ? freeDigits[comb[pos]] : freeDigits[pos];
+                digits[pos][lane] = digit;
+                laneSum += puzzle->letterCoef[letters[pos]] * digit;
+                laneBad += (badMask[pos][lane] >> digit) & 1;
+            }
+            sum[lane] = laneSum;
+            bad[lane] = moreSubsets ? laneBad : n + 1; // Padding lanes never match
+            activeLanes += moreSubsets;
+            
+            // Advance to the next n-subset of the free digits
+            if (moreSubsets) {
+                int k = n - 1;
+                while (k >= 0 && comb[k] == m - n + k) {
+                    k--;
+                }
+                if (k < 0) {
+                    moreSubsets = false;
+                } else {
+                    comb[k]++;
+                    for (int j = k + 1; j < n; j++) {
+                        comb[j] = comb[j - 1] + 1;
+                    }
+                }
+            }
+        }
+        
+        // Heap's algorithm: each step swaps two positions
+        int c[MAX_UNIQUE_CHARS] = {0};
+        long long permutations = 1;
+        LaneVector hits = (sum == 0) & (bad == 0);
+        if (anyLane(&hits)) {
+            reportLaneHits(puzzle, letters, n, digits, &hits);
+        }
+        int i = 1;
+        while (i < n && !puzzle->stopped) {
+            if (c[i] < i) {
+                int j = (i % 2 == 0) ? 0 : c[i];
+                LaneVector di = digits[i], dj = digits[j];
+                sum += (coef[j] - coef[i]) * (di - dj);
+                bad += ((badMask[j] >> di) & 1) + ((badMask[i] >> dj) & 1)
+                     - ((badMask[j] >> dj) & 1) - ((badMask[i] >> di) & 1);
+                digits[i] = dj;
+                digits[j] = di;
+                if ((++permutations & (CANCEL_POLL_INTERVAL - 1)) == 0) {
+                    pollCancel(puzzle);
+                }
+                
+                hits = (sum == 0) & (bad == 0);
+                if (anyLane(&hits)) {
+                    reportLaneHits(puzzle, letters, n, digits, &hits);
+                }
+                c[i]++;
+                i = 1;
+            } else {
+                c[i] = 0;
+                i++;
+            }
+        }
+        checked += permutations * activeLanes;
+    }
+    return checked;
+}
+
+// Count and print a solution found by any of the solvers
+void reportSolution(Puzzle *puzzle) {
+    puzzle->solutionCount++;
+    if (puzzle->maxSolutions > 0 && puzzle->solutionCount >= puzzle->maxSolutions) {
+        puzzle->stopped = true;
+    }
+    if (puzzle->onSolution != NULL) {
+        puzzle->onSolution(puzzle, puzzle->solutionContext);
+        // The handler is the most likely place for a caller to cancel
+        pollCancel(puzzle);
+        return;
+    }
+    printf("\nSolution #%lld:\n", puzzle->solutionCount);
+    printSolution(puzzle);
+}
+
+// Print the solution
+void printSolution(Puzzle *puzzle) {
+    // Print the mapping
+    for (int i = 0; i < puzzle->numUniqueChars; i++) {
+        printf("%c = %d\n", puzzle->uniqueChars[i], puzzle->assigned[i]);
+    }
+    
+    // Print the equation with values
+    printf("\nEquation:\n");
+    for (int i = 0; i < puzzle->numWords; i++) {
+        if (i > 0) {
+            printf("+ ");
+        }
+        printf("%s (", puzzle->words[i]);
+        printWordValue(puzzle, puzzle->words[i]);
+        printf(")\n");
+    }
+    printf("= %s (", puzzle->result);
+    printWordValue(puzzle, puzzle->result);
+    printf(")\n");
+}
+
+// Column-wise search with a memo table of puzzle->memoEntries states
+static void runColumnSolver(Puzzle *puzzle) {
+    puzzle->memo = puzzle->memoEntries > 0 ? createMemoTable(puzzle, puzzle->memoEntries) : NULL;
+    solveByColumns(puzzle, 0, 0, 0);
+    if (puzzle->memo != NULL) {
+        if (puzzle->verbose) {
+            printf("\nMemo: %lld hits, %lld states stored, table grew to %zu entries\n", puzzle->memoHits,
+                   puzzle->memo->stores, puzzle->memo->numBuckets * MEMO_WAYS);
+        }
+        freeMemoTable(puzzle->memo);
+        puzzle->memo = NULL;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Solution cache: puzzles that are the same up to renaming letters share one
+// solution set, kept in memory and appended to a file
+// ---------------------------------------------------------------------------
+
+// One solution set, digits stored per canonical letter
+typedef struct {
+    char *signature;
+    int numLetters;
+    int count;
+    unsigned char *digits;      // count * numLetters
+} CacheEntry;
+
+struct SolutionCache {
+    CacheEntry **slots;         // Open addressing on the signature hash
+    size_t numSlots;
+    size_t numEntries;
+    FILE *file;                 // Every new entry is appended here
+    pthread_mutex_t lock;       // Batch workers share the cache
+};
+
+// Canonical letter-pattern signature of a prepared puzzle, e.g.
+// "10:ABCD+EFGB=EFCBH" for SEND+MORE=MONEY. Addends are taken longest first
+// (stable), then letters are renamed in order of first appearance;
+// canonicalLetter[i] receives the new name of puzzle letter i.
+void canonicalSignature(const Puzzle *puzzle, char *signature, int *canonicalLetter) {
+    static const char symbols[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_@";
+    int order[MAX_WORDS];
+    int numLabels = 0;
+    
+    for (int w = 0; w < puzzle->numWords; w++) {
+        int k = w;
+        while (k > 0 && strlen(puzzle->words[order[k - 1]]) < strlen(puzzle->words[w])) {
+            order[k] = order[k - 1];
+            k--;
+        }
+        order[k] = w;
+    }
+    for (int i = 0; i < puzzle->numUniqueChars; i++) {
+        canonicalLetter[i] = -1;
+    }
+    
+    int length = sprintf(signature, "%d:", puzzle->base);
+    for (int k = 0; k <= puzzle->numWords; k++) {
+        const char *word = (k < puzzle->numWords) ? puzzle->words[order[k]] : puzzle->result;
+        if (k > 0) {
+            signature[length++] = (k < puzzle->numWords) ? '+' : '=';
+        }
+        for (int j = 0; word[j] != '\0'; j++) {
+            int idx = getCharIndex((Puzzle *)puzzle, word[j]);
+            if (canonicalLetter[idx] < 0) {
+                canonicalLetter[idx] = numLabels++;
+            }
+            signature[length++] = symbols[canonicalLetter[idx]];
+        }
+    }
+    signature[length] = '\0';
+}
+
+static size_t hashSignature(const char *signature) {
+    size_t hash = 14695981039346656037ULL;
+    for (const char *p = signature; *p; p++) {
+        hash = (hash ^ (unsigned char)*p) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static CacheEntry **findCacheSlot(SolutionCache *cache, const char *signature) {
+    size_t mask = cache->numSlots - 1;
+    size_t slot = hashSignature(signature) & mask;
+    while (cache->slots[slot] != NULL && strcmp(cache->slots[slot]->signature, signature) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return &cache->slots[slot];
+}
+
+// Add an entry unless its signature is already present; the table is kept
+// at most half full
+static void insertCacheEntry(SolutionCache *cache, CacheEntry *entry) {
+    if (2 * (cache->numEntries + 1) > cache->numSlots) {
+        CacheEntry **old = cache->slots;
+        size_t oldSlots = cache->numSlots;
+        cache->numSlots *= 2;
+        cache->slots = calloc(cache->numSlots, sizeof(CacheEntry *));
+        for (size_t i = 0; i < oldSlots; i++) {
+            if (old[i] != NULL) {
+                *findCacheSlot(cache, old[i]->signature) = old[i];
+            }
+        }
+        free(old);
+    }
+    *findCacheSlot(cache, entry->signature) = entry;
+    cache->numEntries++;
+}
+
+static void freeCacheEntry(CacheEntry *entry) {
+    free(entry->signature);
+    free(entry->digits);
+    free(entry);
+}
+
+// Parse a cache file line: "SIGNATURE LETTERS COUNT d,d,... d,d,..."
+static CacheEntry *parseCacheLine(char *line) {
+    char *save = NULL;
+    char *signature = strtok_r(line, " \r\n", &save);
+    char *letters = strtok_r(NULL, " \r\n", &save);
+    char *count = strtok_r(NULL, " \r\n", &save);
+    if (signature == NULL || letters == NULL || count == NULL) {
+        return NULL;
+    }
+    int base = atoi(signature); // Signatures start with "base:"
+    int numLetters = atoi(letters);
+    int numSolutions = atoi(count);
+    if (base < 2 || base > MAX_BASE || numLetters < 1 || numLetters > base || numSolutions < 0 ||
+        numSolutions > CACHE_MAX_SOLUTIONS) {
+        return NULL;
+    }
+    
+    CacheEntry *entry = malloc(sizeof(CacheEntry));
+    entry->signature = strdup(signature);
+    entry->numLetters = numLetters;
+    entry->count = numSolutions;
+    entry->digits = malloc((size_t)entry->count * entry->numLetters + 1);
+    for (int s = 0; s < entry->count; s++) {
+        char *field = strtok_r(NULL, " \r\n", &save);
+        bool used[MAX_BASE] = {false};
+        for (int i = 0; i < entry->numLetters; i++) {
+            // A damaged file must not turn into solutions: every digit has to
+            // be a number below the base, and no digit may repeat
+            char *end = field;
+            long digit = (field != NULL) ? strtol(field, &end, 10) : -1;
+            if (end == field || digit < 0 || digit >= base || used[digit]) {
+                freeCacheEntry(entry);
+                return NULL;
+            }
+            used[digit] = true;
+            entry->digits[(size_t)s * entry->numLetters + i] = (unsigned char)digit;
+            field = (*end == ',') ? end + 1 : end;
+        }
+    }
+    return entry;
+}
+
+// Load the cache file at 'path' (if it exists) and keep it open to append
+// new entries. Returns NULL if the file cannot be written.
+SolutionCache *openSolutionCache(const char *path) {
+    FILE *file = fopen(path, "a+");
+    if (file == NULL) {
+        return NULL;
+    }
+    
+    SolutionCache *cache = malloc(sizeof(SolutionCache));
+    cache->numSlots = 64;
+    cache->numEntries = 0;
+    cache->slots = calloc(cache->numSlots, sizeof(CacheEntry *));
+    cache->file = file;
+    pthread_mutex_init(&cache->lock, NULL);
+    
+    char *line = NULL;
+    size_t capacity = 0;
+    rewind(file);
+    while (getline(&line, &capacity, file) != -1) {
+        CacheEntry *entry = parseCacheLine(line);
+        if (entry == NULL) {
+            continue;
+        }
+        if (*findCacheSlot(cache, entry->signature) != NULL) {
+            freeCacheEntry(entry);
+        } else {
+            insertCacheEntry(cache, entry);
+        }
+    }
+    free(line);
+    return cache;
+}
+
+void closeSolutionCache(SolutionCache *cache) {
+    for (size_t i = 0; i < cache->numSlots; i++) {
+        if (cache->slots[i] != NULL) {
+            freeCacheEntry(cache->slots[i]);
+        }
+    }
+    free(cache->slots);
+    fclose(cache->file);
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
+
+// Entries are never removed or changed, so the result stays valid after the
+// lock is released
+static const CacheEntry *lookupCache(SolutionCache *cache, const char *signature) {
+    pthread_mutex_lock(&cache->lock);
+    const CacheEntry *entry = *findCacheSlot(cache, signature);
+    pthread_mutex_unlock(&cache->lock);
+    return entry;
+}
+
+static void storeCache(SolutionCache *cache, const char *signature, int numLetters, long long count,
+                       const unsigned char *digits) {
+    pthread_mutex_lock(&cache->lock);
+    if (*findCacheSlot(cache, signature) == NULL) {
+        CacheEntry *entry = malloc(sizeof(CacheEntry));
+        size_t size = (size_t)count * numLetters;
+        entry->signature = strdup(signature);
+        entry->numLetters = numLetters;
+        entry->count = (int)count;  // At most CACHE_MAX_SOLUTIONS
+        entry->digits = malloc(size + 1);
+        memcpy(entry->digits, digits, size);
+        insertCacheEntry(cache, entry);
+        
+        fprintf(cache->file, "%s %d %d", signature, numLetters, entry->count);
+        for (int s = 0; s < count; s++) {
+            for (int i = 0; i < numLetters; i++) {
+                fprintf(cache->file, "%c%d", i > 0 ? ',' : ' ', digits[(size_t)s * numLetters + i]);
+            }
+        }
+        fprintf(cache->file, "\n");
+        fflush(cache->file);
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+// Wraps the caller's handler while a cache miss is solved, keeping a copy of
+// every solution in canonical letter order
+typedef struct {
+    SolutionHandler inner;
+    void *innerContext;
+    const int *canonicalLetter;
+    unsigned char *digits;
+    long long count;
+    int capacity;
+} CacheRecorder;
+
+static void recordSolution(Puzzle *puzzle, void *context) {
+    CacheRecorder *recorder = context;
+    int n = puzzle->numUniqueChars;
+    
+    if (recorder->count < CACHE_MAX_SOLUTIONS) {
+        if (recorder->count == recorder->capacity) {
+            recorder->capacity = recorder->capacity > 0 ? recorder->capacity * 2 : 16;
+            recorder->digits = realloc(recorder->digits, (size_t)recorder->capacity * n);
+        }
+        for (int i = 0; i < n; i++) {
+            recorder->digits[(size_t)recorder->count * n + recorder->canonicalLetter[i]] = puzzle->assigned[i];
+        }
+    }
+    recorder->count++;
+    
+    if (recorder->inner != NULL) {
+        recorder->inner(puzzle, recorder->innerContext);
+    } else {
+        printf("\nSolution #%lld:\n", puzzle->solutionCount);
+        printSolution(puzzle);
+    }
+}
+
+// Run one of the solvers on a prepared puzzle, without the cache
+static void runSearch(Puzzle *puzzle, SolverMode mode, int numThreads) {
+    puzzle->nodes = 0;
+    puzzle->prunes = 0;
+    puzzle->backtracks = 0;
+    puzzle->memoHits = 0;
+    puzzle->tableBytes = 0;
+    puzzle->stopped = false;
+    switch (mode) {
+        case SOLVER_BACKTRACK:
+            if (puzzle->verbose) {
+                printf("Starting backtracking with pre-computed constraints...\n");
+            }
+            solveAllSolutions(puzzle, 0);
+            break;
+        case SOLVER_PROPAGATION: {
+            if (puzzle->verbose) {
+                printf("Starting search with constraint propagation...\n");
+            }
+            PropagationState *state = malloc(sizeof(PropagationState));
+            prepareBranchOrder(puzzle);
+            initPropagationState(puzzle, state);
+            if (propagate(puzzle, state)) {
+                solveWithPropagation(puzzle, state);
+            } else {
+                puzzle->prunes++;
+            }
+            free(state);
+            break;
+        }
+        case SOLVER_PERMUTATION:
+            if (compileEquation(puzzle)) {
+                if (puzzle->verbose) {
+                    printf("Starting permutation brute force...\n");
+                }
+                long long fixedSum = 0;
+                for (int i = 0; i < puzzle->numUniqueChars; i++) {
+                    if (puzzle->fixedAssignment[i]) {
+                        fixedSum += puzzle->letterCoef[i] * puzzle->assigned[i];
+                    }
+                }
+                clock_t permStart = clock();
+                long long checked = solveByPermutations(puzzle, fixedSum);
+                puzzle->nodes = checked;
+                double permSeconds = (double)(clock() - permStart) / CLOCKS_PER_SEC;
+                if (puzzle->verbose) {
+                    printf("\nChecked %lld permutations (%.0f permutations/sec)\n",
+                           checked, permSeconds > 0 ? checked / permSeconds : 0.0);
+                }
+            } else {
+                if (puzzle->verbose) {
+                    printf("Words too long for 64-bit coefficients, using the column-wise search...\n");
+                }
+                runColumnSolver(puzzle);
+            }
+            break;
+        case SOLVER_LINEAR:
+        case SOLVER_PARALLEL:
+        case SOLVER_KERNEL:
+        case SOLVER_MEET:
+            if (compileEquation(puzzle)) {
+                LinearPlan plan;
+                prepareLinearPlan(puzzle, &plan);
+                if (mode == SOLVER_KERNEL && solveWithKernel(puzzle, &plan)) {
+                    break;
+                }
+                if (mode == SOLVER_MEET) {
+                    solveMeetInTheMiddle(puzzle, &plan);
+                    break;
+                }
+                if (mode == SOLVER_KERNEL && puzzle->verbose) {
+                    printf("Could not build the specialised kernel, using the linear solver...\n");
+                }
+                if (mode == SOLVER_PARALLEL) {
+                    if (puzzle->verbose) {
+                        printf("Starting parallel search with %d threads...\n", numThreads);
+                    }
+                    solveLinearParallel(puzzle, &plan, numThreads);
+                } else {
+                    if (puzzle->verbose) {
+                        printf("Starting search on the compiled linear equation...\n");
+                    }
+                    solveLinear(puzzle, &plan, 0, plan.fixedSum);
+                }
+            } else {
+                if (puzzle->verbose) {
+                    printf("Words too long for 64-bit coefficients, using the column-wise search...\n");
+                }
+                runColumnSolver(puzzle);
+            }
+            break;
+        case SOLVER_SAT:
+            if (puzzle->verbose) {
+                printf("Starting CDCL SAT search with blocking clauses...\n");
+            }
+            solveWithSat(puzzle);
+            break;
+        case SOLVER_COLUMNS:
+        default:
+            if (puzzle->verbose) {
+                printf("Starting column-wise search with pre-computed constraints...\n");
+            }
+            runColumnSolver(puzzle);
+            break;
+    }
+}
+
+// Run one of the solvers on a prepared puzzle. With puzzle->cache set, a
+// puzzle isomorphic to a cached one replays the cached solutions relabelled
+// to its own letters, and a complete new solution set is added to the cache.
+void runSolver(Puzzle *puzzle, SolverMode mode, int numThreads) {
+    puzzle->cacheHit = false;
+    if (puzzle->cache == NULL) {
+        runSearch(puzzle, mode, numThreads);
+        return;
+    }
+    
+    char signature[MAX_SIGNATURE];
+    int canonicalLetter[MAX_UNIQUE_CHARS];
+    int n = puzzle->numUniqueChars;
+    canonicalSignature(puzzle, signature, canonicalLetter);
+    
+    const CacheEntry *entry = lookupCache(puzzle->cache, signature);
+    if (entry != NULL && entry->numLetters == n) {
+        puzzle->nodes = 0;
+        puzzle->prunes = 0;
+        puzzle->backtracks = 0;
+        puzzle->memoHits = 0;
+        puzzle->stopped = false;
+        puzzle->cacheHit = true;
+        for (int s = 0; s < entry->count && !pollCancel(puzzle); s++) {
+            for (int i = 0; i < n; i++) {
+                puzzle->assigned[i] = entry->digits[(size_t)s * n + canonicalLetter[i]];
+            }
+            reportSolution(puzzle);
+        }
+        return;
+    }
+    
+    // Solutions must be enumerated one by one to be recorded, so counts are
+    // not taken from the column memo
+    CacheRecorder recorder = {puzzle->onSolution, puzzle->solutionContext, canonicalLetter, NULL, 0, 0};
+    bool countOnly = puzzle->countOnly;
+    puzzle->onSolution = recordSolution;
+    puzzle->solutionContext = &recorder;
+    puzzle->countOnly = false;
+    runSearch(puzzle, mode, numThreads);
+    puzzle->onSolution = recorder.inner;
+    puzzle->solutionContext = recorder.innerContext;
+    puzzle->countOnly = countOnly;
+    
+    if (!puzzle->stopped && recorder.count <= CACHE_MAX_SOLUTIONS) {
+        storeCache(puzzle->cache, signature, n, recorder.count, recorder.digits);
+    }
+    free(recorder.digits);
+}
+
+// Reset a puzzle to the empty state used before reading words
+void initPuzzle(Puzzle *puzzle) {
+    memset(puzzle, 0, sizeof(Puzzle));
+    puzzle->onSolution = NULL;
+    puzzle->solutionContext = NULL;
+    puzzle->verbose = true;
+    puzzle->base = 10;
+    puzzle->variableOrder = ORDER_APPEARANCE;
+    puzzle->memoEntries = MEMO_ENTRIES;
+}
+
+// Parse "WORD+WORD+...=RESULT" (spaces ignored, letters as accepted by
+// isPuzzleLetter for puzzle->base). On failure *error points to a static
+// description.
+bool parsePuzzleString(Puzzle *puzzle, const char *text, const char **error) {
+    char *target = puzzle->words[0];
+    int length = 0;
+    bool seenEquals = false;
+    
+    puzzle->numWords = 0;
+    for (const char *p = text; ; p++) {
+        char c = *p;
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            continue;
+        }
+        if (c == '+' || c == '=' || c == '\0') {
+            if (length == 0) {
+                *error = "empty word";
+                return false;
+            }
+            target[length] = '\0';
+            if (!seenEquals) {
+                puzzle->numWords++;
+            }
+            if (c == '\0') {
+                break;
+            }
+            if (seenEquals) {
+                *error = "operator after '='";
+                return false;
+            }
+            if (c == '=') {
+                seenEquals = true;
+                target = puzzle->result;
+            } else {
+                if (puzzle->numWords >= MAX_WORDS - 1) {
+                    *error = "too many words";
+                    return false;
+                }
+                target = puzzle->words[puzzle->numWords];
+            }
+            length = 0;
+            continue;
+        }
+        if (!isPuzzleLetter(puzzle->base, c)) {
+            *error = "unexpected character";
+            return false;
+        }
+        if (length >= MAX_LEN - 1) {
+            *error = "word too long";
+            return false;
+        }
+        target[length++] = normalizeLetter(puzzle->base, c);
+    }
+    
+    if (!seenEquals) {
+        *error = "missing '='";
+        return false;
+    }
+    return true;
+}
+
+// Find the letters, pre-compute constraints and build the column model
+bool preparePuzzle(Puzzle *puzzle) {
+    if (!findUniqueChars(puzzle)) {
+        return false;
+    }
+    preComputeConstraints(puzzle);
+    return true;
+}
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Growable text buffer for building output records
+typedef struct {
+    char *data;
+    size_t length;
+    size_t capacity;
+} TextBuffer;
+
+static void appendText(TextBuffer *buffer, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int needed = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    
+    if (buffer->length + needed + 1 > buffer->capacity) {
+        size_t capacity = buffer->capacity > 0 ? buffer->capacity : 128;
+        while (buffer->length + needed + 1 > capacity) {
+            capacity *= 2;
+        }
+        buffer->data = realloc(buffer->data, capacity);
+        buffer->capacity = capacity;
+    }
+    
+    va_start(args, format);
+    vsnprintf(buffer->data + buffer->length, needed + 1, format, args);
+    va_end(args);
+    buffer->length += needed;
+}
+
+// Append text as a quoted JSON string or CSV field
+static void appendQuoted(TextBuffer *buffer, const char *text, bool json) {
+    appendText(buffer, "\"");
+    for (const char *p = text; *p; p++) {
+        if (*p == '"') {
+            appendText(buffer, json ? "\\\"" : "\"\"");
+        } else if (*p == '\\' && json) {
+            appendText(buffer, "\\\\");
+        } else if ((unsigned char)*p >= ' ') {
+            appendText(buffer, "%c", *p);
+        }
+    }
+    appendText(buffer, "\"");
+}
+
+// Output record of one batch puzzle
+typedef struct {
+    char *line;
+    TextBuffer record;
+    bool done;
+} BatchItem;
+
+typedef struct {
+    BatchItem *items;
+    int count;
+    bool json;
+    int base;
+    SolutionCache *cache;
+    atomic_int next;
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+} BatchJob;
+
+// Collects solutions of one batch puzzle as "S=9 E=5 ..." strings
+typedef struct {
+    TextBuffer solutions;
+    bool json;
+} BatchSolutions;
+
+static void collectBatchSolution(Puzzle *puzzle, void *context) {
+    BatchSolutions *collected = context;
+    TextBuffer *out = &collected->solutions;
+    
+    if (collected->json) {
+        appendText(out, "%s{", puzzle->solutionCount > 1 ? "," : "");
+        for (int i = 0; i < puzzle->numUniqueChars; i++) {
+            appendText(out, "%s\"%c\":%d", i > 0 ? "," : "", puzzle->uniqueChars[i], puzzle->assigned[i]);
+        }
+        appendText(out, "}");
+    } else {
+        appendText(out, "%s", puzzle->solutionCount > 1 ? "|" : "");
+        for (int i = 0; i < puzzle->numUniqueChars; i++) {
+            appendText(out, "%s%c=%d", i > 0 ? " " : "", puzzle->uniqueChars[i], puzzle->assigned[i]);
+        }
+    }
+}
+
+// Solve one line of a batch file and format its record
+static void solveBatchItem(BatchItem *item, bool json, int base, SolutionCache *cache) {
+    Puzzle *puzzle = malloc(sizeof(Puzzle));
+    BatchSolutions collected = {{NULL, 0, 0}, json};
+    const char *error = NULL;
+    
+    initPuzzle(puzzle);
+    puzzle->base = base;
+    puzzle->cache = cache;
+    puzzle->verbose = false;
+    puzzle->onSolution = collectBatchSolution;
+    puzzle->solutionContext = &collected;
+    
+    double start = nowSeconds();
+    if (!parsePuzzleString(puzzle, item->line, &error)) {
+        // error already set
+    } else if (!preparePuzzle(puzzle)) {
+        error = "too many unique letters";
+    } else {
+        runSolver(puzzle, SOLVER_LINEAR, 1);
+    }
+    double elapsedMs = (nowSeconds() - start) * 1000.0;
+    
+    if (json) {
+        appendText(&item->record, "{\"puzzle\":");
+        appendQuoted(&item->record, item->line, true);
+        appendText(&item->record, ",");
+        if (error != NULL) {
+            appendText(&item->record, "\"status\":\"error\",\"error\":\"%s\"}", error);
+        } else {
+            appendText(&item->record, "\"status\":\"ok\",\"solutions\":%lld,\"nodes\":%lld,\"cached\":%s,\"time_ms\":%.3f,\"assignments\":[%s]}",
+                       puzzle->solutionCount, puzzle->nodes, puzzle->cacheHit ? "true" : "false", elapsedMs,
+                       collected.solutions.data != NULL ? collected.solutions.data : "");
+        }
+    } else {
+        appendQuoted(&item->record, item->line, false);
+        appendText(&item->record, ",");
+        if (error != NULL) {
+            appendText(&item->record, "error,0,0,false,%.3f,\"%s\"", elapsedMs, error);
+        } else {
+            appendText(&item->record, "ok,%lld,%lld,%s,%.3f,\"%s\"", puzzle->solutionCount, puzzle->nodes,
+                       puzzle->cacheHit ? "true" : "false", elapsedMs,
+                       collected.solutions.data != NULL ? collected.solutions.data : "");
+        }
+    }
+    
+    free(collected.solutions.data);
+    free(puzzle);
+}
+
+static void *batchWorker(void *arg) {
+    BatchJob *job = arg;
+    while (true) {
+        int index = atomic_fetch_add(&job->next, 1);
+        if (index >= job->count) {
+            break;
+        }
+        solveBatchItem(&job->items[index], job->json, job->base, job->cache);
+        
+        pthread_mutex_lock(&job->lock);
+        job->items[index].done = true;
+        pthread_cond_broadcast(&job->finished);
+        pthread_mutex_unlock(&job->lock);
+    }
+    return NULL;
+}
+
+// Solve every puzzle of a file (one equation per line, '#' starts a comment)
+// in parallel and write one JSON or CSV record per puzzle, in input order
+int runBatch(const char *inputPath, const char *outputPath, const char *format, int numThreads, int base,
+             SolutionCache *cache) {
+    FILE *input = fopen(inputPath, "r");
+    if (input == NULL) {
+        printf("Error opening %s.\n", inputPath);
+        return 1;
+    }
+    FILE *output = (outputPath != NULL) ? fopen(outputPath, "w") : stdout;
+    if (output == NULL) {
+        printf("Error opening %s.\n", outputPath);
+        fclose(input);
+        return 1;
+    }
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+    if (numThreads > MAX_THREADS) {
+        numThreads = MAX_THREADS;
+    }
+    
+    BatchJob job;
+    int capacity = 0;
+    job.items = NULL;
+    job.count = 0;
+    job.json = strcmp(format, "json") == 0;
+    job.base = base;
+    job.cache = cache;
+    
+    // getline, so a long line is never split into two puzzles
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    while (getline(&line, &lineCapacity, input) != -1) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char *text = line;
+        while (isspace((unsigned char)*text)) {
+            text++;
+        }
+        if (*text == '\0' || *text == '#') {
+            continue;
+        }
+        if (job.count == capacity) {
+            capacity = capacity > 0 ? capacity * 2 : 256;
+            job.items = realloc(job.items, capacity * sizeof(BatchItem));
+        }
+        job.items[job.count++] = (BatchItem){strdup(text), {NULL, 0, 0}, false};
+    }
+    free(line);
+    fclose(input);
+    
+    atomic_init(&job.next, 0);
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.finished, NULL);
+    
+    double start = nowSeconds();
+    pthread_t threads[MAX_THREADS];
+    for (int t = 0; t < numThreads; t++) {
+        pthread_create(&threads[t], NULL, batchWorker, &job);
+    }
+    
+    // Stream records in input order as they complete
+    if (!job.json) {
+        fprintf(output, "puzzle,status,solutions,nodes,cached,time_ms,assignments\n");
+    }
+    for (int i = 0; i < job.count; i++) {
+        pthread_mutex_lock(&job.lock);
+        while (!job.items[i].done) {
+            pthread_cond_wait(&job.finished, &job.lock);
+        }
+        pthread_mutex_unlock(&job.lock);
+        
+        fprintf(output, "%s\n", job.items[i].record.data);
+        free(job.items[i].record.data);
+        free(job.items[i].line);
+    }
+    
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    double elapsed = nowSeconds() - start;
+    fprintf(stderr, "Solved %d puzzles in %.3f s with %d threads (%.1f puzzles/sec)\n",
+            job.count, elapsed, numThreads, elapsed > 0 ? job.count / elapsed : 0.0);
+    
+    if (output != stdout) {
+        fclose(output);
+    }
+    pthread_mutex_destroy(&job.lock);
+    pthread_cond_destroy(&job.finished);
+    free(job.items);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// CDCL SAT backend: the puzzle as CNF, solved by a small conflict-driven
+// clause-learning solver
+// ---------------------------------------------------------------------------
+
+#define SAT_RESTART_BASE 100    // Conflicts per unit of the Luby restart sequence
+#define SAT_ACTIVITY_DECAY 0.95
+
+typedef struct {
+    int *items;
+    int count;
+    int capacity;
+} IntVector;
+
+static void pushInt(IntVector *vector, int value) {
+    if (vector->count == vector->capacity) {
+        vector->capacity = vector->capacity > 0 ? vector->capacity * 2 : 4;
+        vector->items = realloc(vector->items, vector->capacity * sizeof(int));
+    }
+    vector->items[vector->count++] = value;
+}
+
+// Literal 2*v is variable v, 2*v+1 its negation. lits[0] and lits[1] are the
+// watched literals; in a reason clause lits[0] is the implied literal.
+typedef struct {
+    int size;
+    int lits[];
+} Clause;
+
+typedef struct {
+    int numVars;
+    int varCapacity;
+    Clause **clauses;
+    int numClauses;
+    int clauseCapacity;
+    IntVector *watches;         // Per literal: clauses to visit when it becomes false
+    signed char *value;         // Per variable: -1 unassigned, 0 false, 1 true
+    int *level;
+    int *reason;                // Clause that implied the variable, -1 for decisions
+    bool *phase;                // Last value, reused when branching again
+    bool *seen;
+    double *activity;
+    double activityIncrement;
+    int *heap;                  // Max-heap of variables by activity (VSIDS)
+    int *heapIndex;             // Position in the heap, -1 when not in it
+    int heapSize;
+    int *trail;
+    int trailSize;
+    int propagated;             // Trail entries already propagated
+    IntVector trailLimits;      // Trail size at the start of each decision level
+    IntVector cnf;              // Original clauses, 0-terminated with 1-based DIMACS literals
+    int numOriginal;
+    bool unsatisfiable;
+    long long decisions, conflicts, propagations, restarts, learnt;
+} SatSolver;
+
+static int satValue(const SatSolver *s, int lit) {
+    int v = s->value[lit >> 1];
+    return v < 0 ? -1 : v ^ (lit & 1);
+}
+
+static int satLevel(const SatSolver *s) {
+    return s->trailLimits.count;
+}
+
+static bool heapLess(const SatSolver *s, int a, int b) {
+    return s->activity[a] > s->activity[b];
+}
+
+static void heapUp(SatSolver *s, int pos) {
+    int var = s->heap[pos];
+    while (pos > 0 && heapLess(s, var, s->heap[(pos - 1) / 2])) {
+        s->heap[pos] = s->heap[(pos - 1) / 2];
+        s->heapIndex[s->heap[pos]] = pos;
+        pos = (pos - 1) / 2;
+    }
+    s->heap[pos] = var;
+    s->heapIndex[var] = pos;
+}
+
+static void heapDown(SatSolver *s, int pos) {
+    int var = s->heap[pos];
+    while (2 * pos + 1 < s->heapSize) {
+        int child = 2 * pos + 1;
+        if (child + 1 < s->heapSize && heapLess(s, s->heap[child + 1], s->heap[child])) {
+            child++;
+        }
+        if (!heapLess(s, s->heap[child], var)) {
+            break;
+        }
+        s->heap[pos] = s->heap[child];
+        s->heapIndex[s->heap[pos]] = pos;
+        pos = child;
+    }
+    s->heap[pos] = var;
+    s->heapIndex[var] = pos;
+}
+
+static void heapInsert(SatSolver *s, int var) {
+    if (s->heapIndex[var] < 0) {
+        s->heap[s->heapSize] = var;
+        heapUp(s, s->heapSize++);
+    }
+}
+
+static int heapPop(SatSolver *s) {
+    int var = s->heap[0];
+    s->heapIndex[var] = -1;
+    if (--s->heapSize > 0) {
+        s->heap[0] = s->heap[s->heapSize];
+        heapDown(s, 0);
+    }
+    return var;
+}
+
+static int satNewVar(SatSolver *s) {
+    if (s->numVars == s->varCapacity) {
+        int capacity = s->varCapacity > 0 ? s->varCapacity * 2 : 256;
+        s->watches = realloc(s->watches, 2 * capacity * sizeof(IntVector));
+        memset(s->watches + 2 * s->varCapacity, 0, 2 * (capacity - s->varCapacity) * sizeof(IntVector));
+        s->value = realloc(s->value, capacity);
+        s->level = realloc(s->level, capacity * sizeof(int));
+        s->reason = realloc(s->reason, capacity * sizeof(int));
+        s->phase = realloc(s->phase, capacity * sizeof(bool));
+        s->seen = realloc(s->seen, capacity * sizeof(bool));
+        s->activity = realloc(s->activity, capacity * sizeof(double));
+        s->heap = realloc(s->heap, capacity * sizeof(int));
+        s->heapIndex = realloc(s->heapIndex, capacity * sizeof(int));
+        s->trail = realloc(s->trail, capacity * sizeof(int));
+        s->varCapacity = capacity;
+    }
+    int var = s->numVars++;
+    s->value[var] = -1;
+    s->level[var] = 0;
+    s->reason[var] = -1;
+    s->phase[var] = false;
+    s->seen[var] = false;
+    s->activity[var] = 0;
+    s->heapIndex[var] = -1;
+    heapInsert(s, var);
+    return var;
+}
+
+static void satEnqueue(SatSolver *s, int lit, int reason) {
+    int var = lit >> 1;
+    s->value[var] = !(lit & 1);
+    s->level[var] = satLevel(s);
+    s->reason[var] = reason;
+    s->trail[s->trailSize++] = lit;
+}
+
+static int satStoreClause(SatSolver *s, const int *lits, int size) {
+    if (s->numClauses == s->clauseCapacity) {
+        s->clauseCapacity = s->clauseCapacity > 0 ? s->clauseCapacity * 2 : 1024;
+        s->clauses = realloc(s->clauses, s->clauseCapacity * sizeof(Clause *));
+    }
+    Clause *clause = malloc(sizeof(Clause) + size * sizeof(int));
+    clause->size = size;
+    memcpy(clause->lits, lits, size * sizeof(int));
+    s->clauses[s->numClauses] = clause;
+    pushInt(&s->watches[lits[0]], s->numClauses);
+    pushInt(&s->watches[lits[1]], s->numClauses);
+    return s->numClauses++;
+}
+
+// Add a clause at decision level 0, dropping literals already false there
+static void satAddClause(SatSolver *s, const int *lits, int size, bool original) {
+    if (original) {
+        for (int i = 0; i < size; i++) {
+            pushInt(&s->cnf, (lits[i] & 1) ? -((lits[i] >> 1) + 1) : (lits[i] >> 1) + 1);
+        }
+        pushInt(&s->cnf, 0);
+        s->numOriginal++;
+    }
+    
+    int kept[MAX_UNIQUE_CHARS * MAX_BASE];
+    int count = 0;
+    for (int i = 0; i < size; i++) {
+        int value = satValue(s, lits[i]);
+        if (value == 1) {
+            return;
+        }
+        if (value == -1) {
+            kept[count++] = lits[i];
+        }
+    }
+    if (count == 0) {
+        s->unsatisfiable = true;
+    } else if (count == 1) {
+        satEnqueue(s, kept[0], -1);
+    } else {
+        satStoreClause(s, kept, count);
+    }
+}
+
+static void satClause2(SatSolver *s, int a, int b) {
+    int lits[2] = {a, b};
+    satAddClause(s, lits, 2, true);
+}
+
+static void satClause3(SatSolver *s, int a, int b, int c) {
+    int lits[3] = {a, b, c};
+    satAddClause(s, lits, 3, true);
+}
+
+// Unit propagation with two watched literals. Returns a conflicting clause
+// or -1.
+static int satPropagate(SatSolver *s) {
+    while (s->propagated < s->trailSize) {
+        int falseLit = s->trail[s->propagated++] ^ 1;
+        IntVector *watchers = &s->watches[falseLit];
+        int i = 0, j = 0;
+        s->propagations++;
+        
+        while (i < watchers->count) {
+            int index = watchers->items[i++];
+            Clause *clause = s->clauses[index];
+            if (clause->lits[0] == falseLit) {
+                clause->lits[0] = clause->lits[1];
+                clause->lits[1] = falseLit;
+            }
+            if (satValue(s, clause->lits[0]) == 1) {
+                watchers->items[j++] = index;
+                continue;
+            }
+            
+            // Look for a new literal to watch
+            bool moved = false;
+            for (int k = 2; k < clause->size; k++) {
+                if (satValue(s, clause->lits[k]) != 0) {
+                    clause->lits[1] = clause->lits[k];
+                    clause->lits[k] = falseLit;
+                    pushInt(&s->watches[clause->lits[1]], index);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) {
+                continue;
+            }
+            
+            watchers->items[j++] = index;
+            if (satValue(s, clause->lits[0]) == 0) {
+                while (i < watchers->count) {
+                    watchers->items[j++] = watchers->items[i++];
+                }
+                watchers->count = j;
+                return index;
+            }
+            satEnqueue(s, clause->lits[0], index);
+        }
+        watchers->count = j;
+    }
+    return -1;
+}
+
+static void satBump(SatSolver *s, int var) {
+    s->activity[var] += s->activityIncrement;
+    if (s->activity[var] > 1e100) {
+        for (int v = 0; v < s->numVars; v++) {
+            s->activity[v] *= 1e-100;
+        }
+        s->activityIncrement *= 1e-100;
+    }
+    if (s->heapIndex[var] >= 0) {
+        heapUp(s, s->heapIndex[var]);
+    }
+}
+
+static void satCancelUntil(SatSolver *s, int level) {
+    if (satLevel(s) <= level) {
+        return;
+    }
+    int start = s->trailLimits.items[level];
+    for (int i = s->trailSize - 1; i >= start; i--) {
+        int var = s->trail[i] >> 1;
+        s->phase[var] = s->value[var];
+        s->value[var] = -1;
+        heapInsert(s, var);
+    }
+    s->trailSize = start;
+    s->propagated = start;
+    s->trailLimits.count = level;
+}
+
+// First-UIP conflict analysis. Fills 'learnt' (asserting literal first,
+// highest remaining level second) and returns the level to jump back to.
+static int satAnalyze(SatSolver *s, int conflict, IntVector *learnt) {
+    int pathCount = 0;
+    int lit = -1;
+    int index = s->trailSize - 1;
+    learnt->count = 0;
+    pushInt(learnt, 0);
+    
+    do {
+        Clause *clause = s->clauses[conflict];
+        for (int k = (lit == -1) ? 0 : 1; k < clause->size; k++) {
+            int q = clause->lits[k];
+            int var = q >> 1;
+            if (!s->seen[var] && s->level[var] > 0) {
+                satBump(s, var);
+                s->seen[var] = true;
+                if (s->level[var] == satLevel(s)) {
+                    pathCount++;
+                } else {
+                    pushInt(learnt, q);
+                }
+            }
+        }
+        while (!s->seen[s->trail[index] >> 1]) {
+            index--;
+        }
+        lit = s->trail[index--];
+        conflict = s->reason[lit >> 1];
+        s->seen[lit >> 1] = false;
+        pathCount--;
+    } while (pathCount > 0);
+    learnt->items[0] = lit ^ 1;
+    
+    int backLevel = 0;
+    for (int k = 1; k < learnt->count; k++) {
+        int var = learnt->items[k] >> 1;
+        s->seen[var] = false;
+        if (s->level[var] > backLevel) {
+            backLevel = s->level[var];
+            int tmp = learnt->items[1];
+            learnt->items[1] = learnt->items[k];
+            learnt->items[k] = tmp;
+        }
+    }
+    return backLevel;
+}
+
+// Luby sequence 1 1 2 1 1 2 4 1 1 2 ...
+static long long luby(long long i) {
+    long long size = 1, power = 1;
+    while (size < i + 1) {
+        size = 2 * size + 1;
+        power *= 2;
+    }
+    while (size - 1 != i) {
+        size = (size - 1) / 2;
+        power /= 2;
+        i %= size;
+    }
+    return power;
+}
+
+// Search until a model is found (true), the formula is unsatisfiable
+// (false, s->unsatisfiable set) or a restart is due (false)
+static bool satSearch(SatSolver *s, long long conflictLimit, IntVector *learnt) {
+    long long conflicts = 0;
+    while (true) {
+        int conflict = satPropagate(s);
+        if (conflict >= 0) {
+            s->conflicts++;
+            conflicts++;
+            if (satLevel(s) == 0) {
+                s->unsatisfiable = true;
+                return false;
+            }
+            int backLevel = satAnalyze(s, conflict, learnt);
+            satCancelUntil(s, backLevel);
+            if (learnt->count == 1) {
+                satEnqueue(s, learnt->items[0], -1);
+            } else {
+                satEnqueue(s, learnt->items[0], satStoreClause(s, learnt->items, learnt->count));
+                s->learnt++;
+            }
+            s->activityIncrement /= SAT_ACTIVITY_DECAY;
+            continue;
+        }
+        
+        if (conflicts >= conflictLimit) {
+            s->restarts++;
+            satCancelUntil(s, 0);
+            return false;
+        }
+        
+        int var = -1;
+        while (s->heapSize > 0) {
+            int candidate = heapPop(s);
+            if (s->value[candidate] < 0) {
+                var = candidate;
+                break;
+            }
+        }
+        if (var < 0) {
+            return true;
+        }
+        s->decisions++;
+        pushInt(&s->trailLimits, s->trailSize);
+        satEnqueue(s, 2 * var + (s->phase[var] ? 0 : 1), -1);
+    }
+}
+
+static void freeSatSolver(SatSolver *s) {
+    for (int c = 0; c < s->numClauses; c++) {
+        free(s->clauses[c]);
+    }
+    for (int lit = 0; lit < 2 * s->varCapacity; lit++) {
+        free(s->watches[lit].items);
+    }
+    free(s->clauses);
+    free(s->watches);
+    free(s->value);
+    free(s->level);
+    free(s->reason);
+    free(s->phase);
+    free(s->seen);
+    free(s->activity);
+    free(s->heap);
+    free(s->heapIndex);
+    free(s->trail);
+    free(s->trailLimits.items);
+    free(s->cnf.items);
+}
+
+// Encode the puzzle. Letter l has one variable per digit (letterVar[l] + d),
+// exactly one of them true; no digit is taken by two letters. Each column
+// adds its input letters one by one into one-hot partial sums starting from
+// the carry in; the last sum fixes the result digit and the carry out.
+static void encodePuzzle(Puzzle *puzzle, SatSolver *s, int *letterVar) {
+    int base = puzzle->base;
+    int n = puzzle->numUniqueChars;
+    int lits[MAX_BASE] = {0};
+    
+    for (int l = 0; l < n; l++) {
+        letterVar[l] = s->numVars;
+        for (int d = 0; d < base; d++) {
+            satNewVar(s);
+        }
+    }
+    for (int l = 0; l < n; l++) {
+        int count = 0;
+        for (int d = 0; d < base; d++) {
+            bool allowed = puzzle->fixedAssignment[l] ? d == puzzle->assigned[l]
+                                                      : (puzzle->domain[l] & DIGIT_BIT(d)) != 0;
+            if (allowed) {
+                lits[count++] = 2 * (letterVar[l] + d);
+            } else {
+                int unit = 2 * (letterVar[l] + d) + 1;
+                satAddClause(s, &unit, 1, true);
+            }
+        }
+        satAddClause(s, lits, count, true);
+        for (int a = 0; a < base; a++) {
+            for (int b = a + 1; b < base; b++) {
+                satClause2(s, 2 * (letterVar[l] + a) + 1, 2 * (letterVar[l] + b) + 1);
+            }
+        }
+    }
+    for (int d = 0; d < base; d++) {
+        for (int a = 0; a < n; a++) {
+            for (int b = a + 1; b < n; b++) {
+                satClause2(s, 2 * (letterVar[a] + d) + 1, 2 * (letterVar[b] + d) + 1);
+            }
+        }
+    }
+    
+    // Carry into column c, values 0..maxCarry; none into the first column
+    // and none out of the last
+    int maxCarry = puzzle->numWords;
+    int carryVar[MAX_LEN + 1];
+    for (int c = 0; c <= puzzle->numColumns; c++) {
+        carryVar[c] = s->numVars;
+        for (int v = 0; v <= maxCarry; v++) {
+            satNewVar(s);
+        }
+        for (int v = 0; v <= maxCarry; v++) {
+            lits[v] = 2 * (carryVar[c] + v);
+        }
+        satAddClause(s, lits, maxCarry + 1, true);
+        for (int a = 0; a <= maxCarry; a++) {
+            for (int b = a + 1; b <= maxCarry; b++) {
+                satClause2(s, 2 * (carryVar[c] + a) + 1, 2 * (carryVar[c] + b) + 1);
+            }
+        }
+    }
+    int noCarry[2] = {2 * carryVar[0], 2 * carryVar[puzzle->numColumns]};
+    satAddClause(s, &noCarry[0], 1, true);
+    satAddClause(s, &noCarry[1], 1, true);
+    
+    for (int c = 0; c < puzzle->numColumns; c++) {
+        int sumVar = carryVar[c];
+        int sumMax = maxCarry;
+        for (int k = 0; k < puzzle->columnLetterCount[c]; k++) {
+            int letter = puzzle->columnLetters[c][k];
+            int nextVar = s->numVars;
+            int nextMax = sumMax + base - 1;
+            for (int v = 0; v <= nextMax; v++) {
+                satNewVar(s);
+            }
+            for (int v = 0; v <= sumMax; v++) {
+                for (int d = 0; d < base; d++) {
+                    satClause3(s, 2 * (sumVar + v) + 1, 2 * (letterVar[letter] + d) + 1, 2 * (nextVar + v + d));
+                }
+            }
+            sumVar = nextVar;
+            sumMax = nextMax;
+        }
+        
+        int result = puzzle->resultLetter[c];
+        for (int v = 0; v <= sumMax; v++) {
+            int notSum = 2 * (sumVar + v) + 1;
+            if (result == -1) {
+                if (v % base != 0) {
+                    satAddClause(s, &notSum, 1, true);
+                }
+            } else {
+                satClause2(s, notSum, 2 * (letterVar[result] + v % base));
+            }
+            if (v / base > maxCarry) {
+                satAddClause(s, &notSum, 1, true);
+            } else {
+                satClause2(s, notSum, 2 * (carryVar[c + 1] + v / base));
+            }
+        }
+    }
+}
+
+// Write the encoding in DIMACS CNF, with comments naming the letter variables
+static bool writeDimacs(Puzzle *puzzle, SatSolver *s, const int *letterVar, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+    fprintf(file, "c alphametic in base %d\n", puzzle->base);
+    for (int l = 0; l < puzzle->numUniqueChars; l++) {
+        fprintf(file, "c %c = d is variable %d + d\n", puzzle->uniqueChars[l], letterVar[l] + 1);
+    }
+    fprintf(file, "p cnf %d %d\n", s->numVars, s->numOriginal);
+    for (int i = 0; i < s->cnf.count; i++) {
+        fprintf(file, s->cnf.items[i] == 0 ? "0\n" : "%d ", s->cnf.items[i]);
+    }
+    fclose(file);
+    return true;
+}
+
+// SAT solver: encode, then find a model, report it and exclude it with a
+// blocking clause over the letter digits until the formula is unsatisfiable.
+// Writes the CNF to puzzle->dimacsPath first when set.
+void solveWithSat(Puzzle *puzzle) {
+    SatSolver *s = calloc(1, sizeof(SatSolver));
+    int letterVar[MAX_UNIQUE_CHARS];
+    s->activityIncrement = 1;
+    encodePuzzle(puzzle, s, letterVar);
+    
+    if (puzzle->dimacsPath != NULL && !writeDimacs(puzzle, s, letterVar, puzzle->dimacsPath)) {
+        printf("Error opening %s.\n", puzzle->dimacsPath);
+    }
+    if (puzzle->verbose) {
+        printf("CNF: %d variables, %d clauses\n", s->numVars, s->numOriginal);
+    }
+    
+    IntVector learnt = {NULL, 0, 0};
+    int blocking[MAX_UNIQUE_CHARS];
+    long long round = 0;
+    while (!s->unsatisfiable && !pollCancel(puzzle)) {
+        if (!satSearch(s, luby(round++) * SAT_RESTART_BASE, &learnt)) {
+            continue;
+        }
+        
+        int count = 0;
+        for (int l = 0; l < puzzle->numUniqueChars; l++) {
+            for (int d = 0; d < puzzle->base; d++) {
+                if (s->value[letterVar[l] + d] == 1) {
+                    puzzle->assigned[l] = d;
+                }
+            }
+            if (!puzzle->fixedAssignment[l]) {
+                blocking[count++] = 2 * (letterVar[l] + puzzle->assigned[l]) + 1;
+            }
+        }
+        reportSolution(puzzle);
+        
+        satCancelUntil(s, 0);
+        satAddClause(s, blocking, count, false);
+    }
+    
+    puzzle->nodes += s->decisions;
+    puzzle->backtracks += s->conflicts;
+    if (puzzle->verbose) {
+        printf("\nSAT: %lld decisions, %lld conflicts, %lld propagations, %lld learnt clauses, %lld restarts\n",
+               s->decisions, s->conflicts, s->propagations, s->learnt, s->restarts);
+    }
+    free(learnt.items);
+    freeSatSolver(s);
+    free(s);
+}
+
+// ---------------------------------------------------------------------------
+// Specialised kernels: the linear plan of one puzzle written out as C with
+// its coefficients, domains and bounds as constants and one loop per letter,
+// compiled by the system compiler and loaded with dlopen
+// ---------------------------------------------------------------------------
+
+// Kernel interface: report() gets the digit of every letter and returns
+// nonzero to stop; poll() is called every 65536 nodes and also returns
+// nonzero to stop. The kernel returns the number of nodes it visited.
+typedef int (*KernelReport)(void *context, const int *digits);
+typedef int (*KernelPoll)(void *context);
+typedef long long (*KernelFunction)(KernelReport report, KernelPoll poll, void *context);
+
+static void indent(FILE *file, int level) {
+    fprintf(file, "%*s", 4 * level, "");
+}
+
+// Letters are assigned in plan order. The last free letter is not searched:
+// it is the one digit that brings the sum to zero.
+static void writeKernelSource(Puzzle *puzzle, const LinearPlan *plan, FILE *file) {
+    int n = plan->numFree;
+    DigitMask used = 0;
+    
+    fprintf(file, "// Specialised solver for ");
+    for (int w = 0; w < puzzle->numWords; w++) {
+        fprintf(file, "%s%s", w > 0 ? "+" : "", puzzle->words[w]);
+    }
+    fprintf(file, "=%s in base %d\n", puzzle->result, puzzle->base);
+    fprintf(file, "typedef int (*KernelReport)(void *context, const int *digits);\n");
+    fprintf(file, "typedef int (*KernelPoll)(void *context);\n\n");
+    fprintf(file, "long long %s(KernelReport report, KernelPoll poll, void *context) {\n", KERNEL_SYMBOL);
+    fprintf(file, "    int digits[%d] = {", puzzle->numUniqueChars);
+    for (int i = 0; i < puzzle->numUniqueChars; i++) {
+        fprintf(file, "%s%d", i > 0 ? ", " : "", puzzle->fixedAssignment[i] ? puzzle->assigned[i] : -1);
+        if (puzzle->fixedAssignment[i]) {
+            used |= DIGIT_BIT(puzzle->assigned[i]);
+        }
+    }
+    fprintf(file, "};\n");
+    fprintf(file, "    long long nodes = 0;\n");
+    fprintf(file, "    const unsigned long long u0 = 0x%llxULL;\n", (unsigned long long)used);
+    fprintf(file, "    const long long s0 = %lldLL;\n", plan->fixedSum);
+    
+    for (int k = 0; k < n; k++) {
+        int idx = plan->order[k];
+        long long coef = puzzle->letterCoef[idx];
+        unsigned long long domain = puzzle->domain[idx] & allDigits(puzzle->base);
+        
+        if (k == n - 1 && coef != 0) {
+            // s + coef * d = 0 has at most one digit solution
+            indent(file, k + 1);
+            fprintf(file, "if (s%d %% %lldLL == 0) {\n", k, coef);
+            indent(file, k + 2);
+            fprintf(file, "long long d = -s%d / %lldLL;\n", k, coef);
+            indent(file, k + 2);
+            fprintf(file, "if (d >= 0 && d < %d && ((0x%llxULL & ~u%d) >> d & 1)) {\n", puzzle->base, domain, k);
+            indent(file, k + 3);
+            fprintf(file, "digits[%d] = (int)d;\n", idx);
+            indent(file, k + 3);
+            fprintf(file, "nodes++;\n");
+            indent(file, k + 3);
+            fprintf(file, "if (report(context, digits)) goto done;\n");
+            indent(file, k + 2);
+            fprintf(file, "}\n");
+            indent(file, k + 1);
+            fprintf(file, "}\n");
+            break;
+        }
+        
+        indent(file, k + 1);
+        fprintf(file, "for (unsigned long long m%d = 0x%llxULL & ~u%d; m%d; m%d &= m%d - 1) {\n", k, domain, k, k, k, k);
+        indent(file, k + 2);
+        fprintf(file, "int d%d = __builtin_ctzll(m%d);\n", k, k);
+        indent(file, k + 2);
+        fprintf(file, "long long s%d = s%d + %lldLL * d%d;\n", k + 1, k, coef, k);
+        indent(file, k + 2);
+        fprintf(file, "if (s%d > %lldLL || s%d < %lldLL) continue;\n",
+                k + 1, -plan->suffixMin[k + 1], k + 1, -plan->suffixMax[k + 1]);
+        indent(file, k + 2);
+        fprintf(file, "unsigned long long u%d = u%d | 1ULL << d%d;\n", k + 1, k, k);
+        indent(file, k + 2);
+        fprintf(file, "digits[%d] = d%d;\n", idx, k);
+        indent(file, k + 2);
+        fprintf(file, "if ((++nodes & 0xFFFF) == 0 && poll(context)) goto done;\n");
+        if (k == n - 1) {
+            indent(file, k + 2);
+            fprintf(file, "if (s%d == 0 && report(context, digits)) goto done;\n", k + 1);
+        }
+    }
+    if (n == 0) {
+        fprintf(file, "    if (s0 == 0) report(context, digits);\n");
+    }
+    for (int k = (n > 0 && puzzle->letterCoef[plan->order[n - 1]] != 0) ? n - 2 : n - 1; k >= 0; k--) {
+        indent(file, k + 1);
+        fprintf(file, "}\n");
+    }
+    fprintf(file, "    goto done;\n");
+    fprintf(file, "done:\n");
+    fprintf(file, "    return nodes;\n");
+    fprintf(file, "}\n");
+}
+
+static int reportKernelSolution(void *context, const int *digits) {
+    Puzzle *puzzle = context;
+    for (int i = 0; i < puzzle->numUniqueChars; i++) {
+        puzzle->assigned[i] = digits[i];
+    }
+    reportSolution(puzzle);
+    return puzzle->stopped;
+}
+
+static int pollKernel(void *context) {
+    return pollCancel(context);
+}
+
+// Generate, compile ($CC or cc) and run the specialised kernel. The source
+// goes to puzzle->kernelPath when set, otherwise to a temporary directory.
+// Returns false, before any solution is reported, if the kernel could not
+// be built or loaded. The paths go into a shell command in single quotes,
+// so a source path containing one is refused.
+bool solveWithKernel(Puzzle *puzzle, const LinearPlan *plan) {
+    char directory[] = "/tmp/alphameticXXXXXX";
+    char sourcePath[4096], libraryPath[sizeof(directory) + 16], command[8192];
+    if (puzzle->kernelPath != NULL && strchr(puzzle->kernelPath, '\'') != NULL) {
+        return false;
+    }
+    if (mkdtemp(directory) == NULL) {
+        return false;
+    }
+    snprintf(libraryPath, sizeof(libraryPath), "%s/kernel.so", directory);
+    if (puzzle->kernelPath != NULL) {
+        snprintf(sourcePath, sizeof(sourcePath), "%s", puzzle->kernelPath);
+    } else {
+        snprintf(sourcePath, sizeof(sourcePath), "%s/kernel.c", directory);
+    }
+    
+    bool loaded = false;
+    FILE *file = fopen(sourcePath, "w");
+    if (file != NULL) {
+        writeKernelSource(puzzle, plan, file);
+        fclose(file);
+        
+        const char *compiler = getenv("CC") != NULL ? getenv("CC") : "cc";
+        snprintf(command, sizeof(command), "%s -O2 -march=native -w -shared -fPIC -o '%s' '%s'",
+                 compiler, libraryPath, sourcePath);
+        double start = nowSeconds();
+        if (system(command) == 0) {
+            void *library = dlopen(libraryPath, RTLD_NOW | RTLD_LOCAL);
+            KernelFunction kernel = library != NULL ? (KernelFunction)dlsym(library, KERNEL_SYMBOL) : NULL;
+            if (kernel != NULL) {
+                if (puzzle->verbose) {
+                    printf("Compiled a specialised kernel in %.1f ms\n", (nowSeconds() - start) * 1000.0);
+                }
+                puzzle->nodes += kernel(reportKernelSolution, pollKernel, puzzle);
+                loaded = true;
+            }
+            if (library != NULL) {
+                dlclose(library);
+            }
+        }
+    }
+    
+    unlink(libraryPath);
+    if (puzzle->kernelPath == NULL) {
+        unlink(sourcePath);
+    }
+    rmdir(directory);
+    return loaded;
+}
+
+// ---------------------------------------------------------------------------
+// Meet in the middle: the letters with the smallest coefficients are
+// enumerated once into a hash table keyed by their partial sum, then the
+// search over the other letters looks up the sum that completes each of
+// its assignments instead of branching further
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    long long sum;          // Weighted sum of this assignment of the right half
+    DigitMask used;         // Its own digits, to check disjointness with the left half
+    int next;               // Next entry in the same bucket, -1 ends the chain
+} MeetEntry;
+
+typedef struct {
+    int split;              // plan->order[split..numFree-1] form the right half
+    int width;              // Letters in the right half
+    MeetEntry *entries;
+    unsigned char *digits;  // 'width' digits per entry
+    int count;
+    int capacity;
+    int *buckets;           // First entry of each bucket, -1 when empty
+    unsigned long long bucketMask;
+    long long lowest;       // Right-half sums outside [lowest, highest] can never match
+    long long highest;
+    DigitMask fixed;        // Digits of the pre-assigned letters
+} MeetTable;
+
+static inline unsigned long long meetBucket(const MeetTable *table, long long sum) {
+    return ((unsigned long long)sum * 0x9E3779B97F4A7C15ULL >> 20) & table->bucketMask;
+}
+
+// Every injective assignment of the right half, restricted to the digits
+// that are still free after the fixed letters
+static void tabulateRightHalf(Puzzle *puzzle, const LinearPlan *plan, MeetTable *table, int depth,
+                              long long sum, DigitMask used, unsigned char *digits) {
+    countNode(puzzle);
+    if (puzzle->stopped) {
+        return;
+    }
+    if (depth == plan->numFree) {
+        if (sum < table->lowest || sum > table->highest) {
+            puzzle->prunes++;
+            return;
+        }
+        if (table->count == table->capacity) {
+            table->capacity = table->capacity > 0 ? table->capacity * 2 : 1024;
+            table->entries = realloc(table->entries, table->capacity * sizeof(MeetEntry));
+            table->digits = realloc(table->digits, (size_t)table->capacity * table->width);
+        }
+        MeetEntry *entry = &table->entries[table->count];
+        entry->sum = sum;
+        entry->used = used & ~table->fixed;
+        memcpy(table->digits + (size_t)table->count * table->width, digits, table->width);
+        table->count++;
+        return;
+    }
+    
+    int idx = plan->order[depth];
+    DigitMask choices = puzzle->domain[idx] & ~used;
+    while (choices) {
+        int digit = minDigit(choices);
+        choices &= choices - 1;
+        digits[depth - table->split] = (unsigned char)digit;
+        tabulateRightHalf(puzzle, plan, table, depth + 1, sum + puzzle->letterCoef[idx] * digit,
+                          used | DIGIT_BIT(digit), digits);
+    }
+}
+
+// Search the left half as solveLinear does; at the split look up the
+// right-half assignments whose sum brings the total to zero
+static bool joinLeftHalf(Puzzle *puzzle, const LinearPlan *plan, const MeetTable *table, int depth,
+                         long long partialSum, DigitMask used) {
+    countNode(puzzle);
+    
+    if (depth == table->split) {
+        bool foundAnySolution = false;
+        long long target = -partialSum;
+        for (int e = table->buckets[meetBucket(table, target)]; e >= 0 && !puzzle->stopped;
+             e = table->entries[e].next) {
+            const MeetEntry *entry = &table->entries[e];
+            if (entry->sum != target || (entry->used & used) != 0) {
+                continue;
+            }
+            const unsigned char *digits = table->digits + (size_t)e * table->width;
+            for (int k = 0; k < table->width; k++) {
+                puzzle->assigned[plan->order[table->split + k]] = digits[k];
+            }
+            reportSolution(puzzle);
+            foundAnySolution = true;
+        }
+        return foundAnySolution;
+    }
+    
+    int idx = plan->order[depth];
+    long long coef = puzzle->letterCoef[idx];
+    bool foundAnySolution = false;
+    
+    DigitMask choices = puzzle->domain[idx] & ~used;
+    while (choices && !puzzle->stopped) {
+        int digit = minDigit(choices);
+        choices &= choices - 1;
+        
+        long long sum = partialSum + coef * digit;
+        if (sum + plan->suffixMin[depth + 1] > 0 || sum + plan->suffixMax[depth + 1] < 0) {
+            puzzle->prunes++;
+            continue;
+        }
+        
+        puzzle->assigned[idx] = digit;
+        if (joinLeftHalf(puzzle, plan, table, depth + 1, sum, used | DIGIT_BIT(digit))) {
+            foundAnySolution = true;
+        } else {
+            puzzle->backtracks++;
+        }
+        puzzle->assigned[idx] = -1;
+    }
+    return foundAnySolution;
+}
+
+// Split the plan order in half, moving letters to the left half while the
+// right half could exceed MEET_MAX_ENTRIES assignments. The left half gets
+// the large coefficients, where the partial-sum bounds prune best. A small
+// table wins: it stays in cache, and in large bases a big right half gives
+// long chains of equal sums whose digits mostly clash with the left half.
+void solveMeetInTheMiddle(Puzzle *puzzle, const LinearPlan *plan) {
+    MeetTable table;
+    memset(&table, 0, sizeof(MeetTable));
+    
+    DigitMask used = 0;
+    for (int i = 0; i < puzzle->numUniqueChars; i++) {
+        if (puzzle->fixedAssignment[i]) {
+            used |= DIGIT_BIT(puzzle->assigned[i]);
+        }
+    }
+    table.fixed = used;
+    int available = puzzle->base - __builtin_popcountll(used);
+    
+    table.split = plan->numFree / 2;
+    for (;;) {
+        double estimate = 1;
+        for (int k = table.split; k < plan->numFree; k++) {
+            int choices = __builtin_popcountll(puzzle->domain[plan->order[k]] & ~used);
+            estimate *= choices < available - (k - table.split) ? choices : available - (k - table.split);
+        }
+        if (estimate <= MEET_MAX_ENTRIES || table.split == plan->numFree) {
+            break;
+        }
+        table.split++;
+    }
+    table.width = plan->numFree - table.split;
+    
+    // The right half has to cancel fixedSum plus whatever the left half adds
+    long long leftMin = plan->suffixMin[0] - plan->suffixMin[table.split];
+    long long leftMax = plan->suffixMax[0] - plan->suffixMax[table.split];
+    table.lowest = -(plan->fixedSum + leftMax);
+    table.highest = -(plan->fixedSum + leftMin);
+    
+    unsigned char digits[MAX_UNIQUE_CHARS];
+    tabulateRightHalf(puzzle, plan, &table, table.split, 0, used, digits);
+    
+    int numBuckets = 1;
+    while (numBuckets < 2 * table.count) {
+        numBuckets *= 2;
+    }
+    table.bucketMask = numBuckets - 1;
+    table.buckets = malloc(numBuckets * sizeof(int));
+    for (int b = 0; b < numBuckets; b++) {
+        table.buckets[b] = -1;
+    }
+    for (int e = 0; e < table.count; e++) {
+        unsigned long long b = meetBucket(&table, table.entries[e].sum);
+        table.entries[e].next = table.buckets[b];
+        table.buckets[b] = e;
+    }
+    puzzle->tableBytes = (long long)table.capacity * (sizeof(MeetEntry) + table.width) +
+                         (long long)numBuckets * sizeof(int);
+    
+    if (puzzle->verbose) {
+        printf("Meet in the middle: %d + %d letters, %d table entries (%.1f KiB)\n", table.split,
+               table.width, table.count, puzzle->tableBytes / 1024.0);
+    }
+    if (!puzzle->stopped) {
+        joinLeftHalf(puzzle, plan, &table, 0, plan->fixedSum, used);
+    }
+    
+    free(table.entries);
+    free(table.digits);
+    free(table.buckets);
+}
+
+// ---------------------------------------------------------------------------
+// General alphametics: +, -, * over words and numbers, several equations and
+// inequalities sharing letters
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    AlphameticSystem *system;
+    const char *text;
+    int pos;
+    const char *error;
+    char wordText[MAX_EXPR_NODES][MAX_LEN];  // Spelling of EXPR_WORD nodes
+} ExprParser;
+
+static void skipSpaces(ExprParser *parser) {
+    while (isspace((unsigned char)parser->text[parser->pos])) {
+        parser->pos++;
+    }
+}
+
+// Return an existing identical node or create a new one
+static int addExprNode(ExprParser *parser, ExprNode node, const char *word) {
+    AlphameticSystem *system = parser->system;
+    for (int i = 0; i < system->numNodes; i++) {
+        ExprNode *other = &system->nodes[i];
+        if (other->op != node.op) {
+            continue;
+        }
+        if ((node.op == EXPR_WORD && strcmp(parser->wordText[i], word) == 0) ||
+            (node.op == EXPR_NUMBER && other->number == node.number) ||
+            (node.op != EXPR_WORD && node.op != EXPR_NUMBER &&
+             other->left == node.left && other->right == node.right)) {
+            return i;
+        }
+    }
+    if (system->numNodes >= MAX_EXPR_NODES) {
+        parser->error = "expression too large";
+        return -1;
+    }
+    if (word != NULL) {
+        strcpy(parser->wordText[system->numNodes], word);
+    }
+    system->nodes[system->numNodes] = node;
+    return system->numNodes++;
+}
+
+static int parseExprSum(ExprParser *parser);
+
+static int parseExprFactor(ExprParser *parser) {
+    skipSpaces(parser);
+    char c = parser->text[parser->pos];
+    
+    if (c == '(') {
+        parser->pos++;
+        int node = parseExprSum(parser);
+        skipSpaces(parser);
+        if (node < 0) {
+            return -1;
+        }
+        if (parser->text[parser->pos] != ')') {
+            parser->error = "missing ')'";
+            return -1;
+        }
+        parser->pos++;
+        return node;
+    }
+    
+    char token[MAX_LEN];
+    int length = 0;
+    bool isNumber = isdigit((unsigned char)c);
+    while (isalnum((unsigned char)parser->text[parser->pos])) {
+        char ch = parser->text[parser->pos];
+        if (isNumber != (bool)isdigit((unsigned char)ch)) {
+            parser->error = "letters and digits mixed in one word";
+            return -1;
+        }
+        if (length >= MAX_LEN - 1) {
+            parser->error = "word too long";
+            return -1;
+        }
+        token[length++] = toupper((unsigned char)ch);
+        parser->pos++;
+    }
+    token[length] = '\0';
+    if (length == 0) {
+        parser->error = "expected a word, number or '('";
+        return -1;
+    }
+    
+    ExprNode node = {0};
+    if (isNumber) {
+        node.op = EXPR_NUMBER;
+        node.number = strtoll(token, NULL, 10);
+        return addExprNode(parser, node, NULL);
+    }
+    
+    AlphameticSystem *system = parser->system;
+    node.op = EXPR_WORD;
+    node.length = length;
+    for (int i = 0; i < length; i++) {
+        int idx = 0;
+        while (idx < system->numLetters && system->letters[idx] != token[i]) {
+            idx++;
+        }
+        if (idx == system->numLetters) {
+            if (system->numLetters >= EXPR_BASE) {
+                parser->error = "too many unique letters";
+                return -1;
+            }
+            system->letters[system->numLetters++] = token[i];
+        }
+        node.letters[i] = idx;
+    }
+    return addExprNode(parser, node, token);
+}
+
+static int parseExprProduct(ExprParser *parser) {
+    int left = parseExprFactor(parser);
+    while (left >= 0) {
+        skipSpaces(parser);
+        if (parser->text[parser->pos] != '*') {
+            break;
+        }
+        parser->pos++;
+        int right = parseExprFactor(parser);
+        if (right < 0) {
+            return -1;
+        }
+        left = addExprNode(parser, (ExprNode){.op = EXPR_MUL, .left = left, .right = right}, NULL);
+    }
+    return left;
+}
+
+static int parseExprSum(ExprParser *parser) {
+    int left = parseExprProduct(parser);
+    while (left >= 0) {
+        skipSpaces(parser);
+        char c = parser->text[parser->pos];
+        if (c != '+' && c != '-') {
+            break;
+        }
+        parser->pos++;
+        int right = parseExprProduct(parser);
+        if (right < 0) {
+            return -1;
+        }
+        ExprOp op = (c == '+') ? EXPR_ADD : EXPR_SUB;
+        left = addExprNode(parser, (ExprNode){.op = op, .left = left, .right = right}, NULL);
+    }
+    return left;
+}
+
+static bool parseRelation(ExprParser *parser, Relation *relation) {
+    skipSpaces(parser);
+    const char *p = parser->text + parser->pos;
+    static const struct {
+        const char *token;
+        Relation relation;
+    } relations[] = {
+        {"==", REL_EQ}, {"!=", REL_NE}, {"<=", REL_LE}, {">=", REL_GE},
+        {"=", REL_EQ}, {"<", REL_LT}, {">", REL_GT}
+    };
+    for (int i = 0; i < (int)(sizeof(relations) / sizeof(relations[0])); i++) {
+        int length = strlen(relations[i].token);
+        if (strncmp(p, relations[i].token, length) == 0) {
+            parser->pos += length;
+            *relation = relations[i].relation;
+            return true;
+        }
+    }
+    parser->error = "expected a relation (=, !=, <, <=, >, >=)";
+    return false;
+}
+
+// Number of trailing digits of a node known once 'depth' letters are
+// assigned (MAX_LEN when the whole value is known)
+static int knownDigits(AlphameticSystem *system, int k, int depth) {
+    ExprNode *node = &system->nodes[k];
+    switch (node->op) {
+        case EXPR_WORD: {
+            int known = 0;
+            while (known < node->length && node->letters[node->length - 1 - known] < depth) {
+                known++;
+            }
+            return known == node->length ? MAX_LEN : known;
+        }
+        case EXPR_NUMBER:
+            return MAX_LEN;
+        default: {
+            int a = knownDigits(system, node->left, depth);
+            int b = knownDigits(system, node->right, depth);
+            return a < b ? a : b;
+        }
+    }
+}
+
+// Order the letters column by column from the right, so the low digits of
+// every word are known early, then work out at which depth every node,
+// constraint and modular check can be evaluated
+static void scheduleSystem(AlphameticSystem *system) {
+    int n = system->numLetters;
+    int rank[MAX_UNIQUE_CHARS];
+    int next = 0;
+    for (int i = 0; i < n; i++) {
+        rank[i] = -1;
+    }
+    
+    for (int column = 0; column < MAX_LEN; column++) {
+        for (int k = 0; k < system->numNodes; k++) {
+            ExprNode *node = &system->nodes[k];
+            if (node->op != EXPR_WORD || column >= node->length) {
+                continue;
+            }
+            int idx = node->letters[node->length - 1 - column];
+            if (rank[idx] == -1) {
+                rank[idx] = next++;
+            }
+        }
+    }
+    
+    // Renumber the letters into branching order
+    char letters[MAX_UNIQUE_CHARS];
+    for (int i = 0; i < n; i++) {
+        letters[rank[i]] = system->letters[i];
+    }
+    memcpy(system->letters, letters, n);
+    
+    for (int k = 0; k < system->numNodes; k++) {
+        ExprNode *node = &system->nodes[k];
+        node->readyDepth = 0;
+        if (node->op == EXPR_WORD) {
+            for (int i = 0; i < node->length; i++) {
+                node->letters[i] = rank[node->letters[i]];
+                if (node->letters[i] + 1 > node->readyDepth) {
+                    node->readyDepth = node->letters[i] + 1;
+                }
+            }
+        } else if (node->op != EXPR_NUMBER) {
+            // Operands are always created before the node using them
+            int a = system->nodes[node->left].readyDepth;
+            int b = system->nodes[node->right].readyDepth;
+            node->readyDepth = a > b ? a : b;
+        }
+    }
+    for (int c = 0; c < system->numConstraints; c++) {
+        ExprConstraint *constraint = &system->constraints[c];
+        int a = system->nodes[constraint->left].readyDepth;
+        int b = system->nodes[constraint->right].readyDepth;
+        constraint->readyDepth = a > b ? a : b;
+    }
+    
+    // Bucket nodes (in creation order, which is topological) and constraints by depth
+    int count = 0;
+    for (int depth = 0; depth <= n; depth++) {
+        system->nodeStart[depth] = count;
+        for (int k = 0; k < system->numNodes; k++) {
+            if (system->nodes[k].readyDepth == depth) {
+                system->nodeOrder[count++] = k;
+            }
+        }
+    }
+    system->nodeStart[n + 1] = count;
+    count = 0;
+    for (int depth = 0; depth <= n; depth++) {
+        system->constraintStart[depth] = count;
+        for (int c = 0; c < system->numConstraints; c++) {
+            if (system->constraints[c].readyDepth == depth) {
+                system->constraintOrder[count++] = c;
+            }
+        }
+    }
+    system->constraintStart[n + 1] = count;
+    
+    count = 0;
+    for (int depth = 0; depth <= n; depth++) {
+        system->modCheckStart[depth] = count;
+        for (int c = 0; c < system->numConstraints; c++) {
+            ExprConstraint *constraint = &system->constraints[c];
+            if (constraint->relation != REL_EQ || constraint->readyDepth <= depth) {
+                continue;
+            }
+            int a = knownDigits(system, constraint->left, depth);
+            int b = knownDigits(system, constraint->right, depth);
+            int digits = a < b ? a : b;
+            int before = 0;
+            if (depth > 0) {
+                a = knownDigits(system, constraint->left, depth - 1);
+                b = knownDigits(system, constraint->right, depth - 1);
+                before = a < b ? a : b;
+            }
+            if (digits > before && digits <= 18) {
+                system->modCheckConstraint[count] = c;
+                system->modCheckDigits[count] = digits;
+                count++;
+            }
+        }
+    }
+    system->modCheckStart[n + 1] = count;
+    
+    // Leading letters of multi-digit words cannot be zero
+    for (int i = 0; i < n; i++) {
+        system->domain[i] = allDigits(EXPR_BASE);
+    }
+    for (int k = 0; k < system->numNodes; k++) {
+        ExprNode *node = &system->nodes[k];
+        if (node->op == EXPR_WORD && node->length > 1) {
+            system->domain[node->letters[0]] &= ~DIGIT_BIT(0);
+        }
+    }
+}
+
+// Parse "expr rel expr" statements separated by ';' or ','.
+// On failure *error points to a static description.
+bool parseAlphameticSystem(AlphameticSystem *system, const char *text, const char **error) {
+    ExprParser *parser = calloc(1, sizeof(ExprParser));
+    memset(system, 0, sizeof(AlphameticSystem));
+    system->verbose = true;
+    parser->system = system;
+    parser->text = text;
+    
+    while (parser->error == NULL) {
+        int left = parseExprSum(parser);
+        Relation relation;
+        if (left < 0 || !parseRelation(parser, &relation)) {
+            break;
+        }
+        int right = parseExprSum(parser);
+        if (right < 0) {
+            break;
+        }
+        if (system->numConstraints >= MAX_EXPR_CONSTRAINTS) {
+            parser->error = "too many equations";
+            break;
+        }
+        system->constraints[system->numConstraints++] = (ExprConstraint){left, right, relation, 0};
+        
+        skipSpaces(parser);
+        char c = parser->text[parser->pos];
+        if (c == '\0') {
+            break;
+        }
+        if (c != ';' && c != ',') {
+            parser->error = "expected ';' between equations";
+            break;
+        }
+        parser->pos++;
+        skipSpaces(parser);
+        if (parser->text[parser->pos] == '\0') {
+            break;
+        }
+    }
+    
+    bool ok = parser->error == NULL;
+    *error = parser->error;
+    if (ok) {
+        scheduleSystem(system);
+    }
+    free(parser);
+    return ok;
+}
+
+// Evaluate one node from its operands (or letters). Returns false if the
+// value does not fit in an ExprValue.
+static bool evaluateExprNode(AlphameticSystem *system, int k) {
+    ExprNode *node = &system->nodes[k];
+    ExprValue result = 0;
+    bool overflow = false;
+    
+    switch (node->op) {
+        case EXPR_WORD:
+            for (int i = 0; i < node->length && !overflow; i++) {
+                overflow = __builtin_mul_overflow(result, 10, &result) ||
+                           __builtin_add_overflow(result, system->assigned[node->letters[i]], &result);
+            }
+            break;
+        case EXPR_NUMBER:
+            result = node->number;
+            break;
+        case EXPR_ADD:
+        case EXPR_SUB:
+        case EXPR_MUL: {
+            ExprValue a = system->value[node->left];
+            ExprValue b = system->value[node->right];
+            if (node->op == EXPR_ADD) {
+                overflow = __builtin_add_overflow(a, b, &result);
+            } else if (node->op == EXPR_SUB) {
+                overflow = __builtin_sub_overflow(a, b, &result);
+            } else {
+                overflow = __builtin_mul_overflow(a, b, &result);
+            }
+            break;
+        }
+    }
+    system->value[k] = result;
+    return !overflow;
+}
+
+// Value of a node modulo 'modulus', from the trailing digits of its words
+static long long evaluateExprMod(AlphameticSystem *system, int k, long long modulus) {
+    ExprNode *node = &system->nodes[k];
+    switch (node->op) {
+        case EXPR_WORD: {
+            long long result = 0, place = 1;
+            for (int i = node->length - 1; i >= 0 && place < modulus; i--) {
+                result += system->assigned[node->letters[i]] * place;
+                place *= 10;
+            }
+            return result % modulus;
+        }
+        case EXPR_NUMBER:
+            return node->number % modulus;
+        default: {
+            long long a = evaluateExprMod(system, node->left, modulus);
+            long long b = evaluateExprMod(system, node->right, modulus);
+            if (node->op == EXPR_ADD) {
+                return (a + b) % modulus;
+            }
+            if (node->op == EXPR_SUB) {
+                return ((a - b) % modulus + modulus) % modulus;
+            }
+            return (long long)((__int128)a * b % modulus);
+        }
+    }
+}
+
+static bool constraintHolds(AlphameticSystem *system, ExprConstraint *constraint) {
+    ExprValue a = system->value[constraint->left];
+    ExprValue b = system->value[constraint->right];
+    switch (constraint->relation) {
+        case REL_EQ: return a == b;
+        case REL_NE: return a != b;
+        case REL_LT: return a < b;
+        case REL_LE: return a <= b;
+        case REL_GT: return a > b;
+        case REL_GE: return a >= b;
+    }
+    return false;
+}
+
+static void printExprNode(AlphameticSystem *system, int k) {
+    ExprNode *node = &system->nodes[k];
+    switch (node->op) {
+        case EXPR_WORD:
+            for (int i = 0; i < node->length; i++) {
+                printf("%c", system->letters[node->letters[i]]);
+            }
+            break;
+        case EXPR_NUMBER:
+            printf("%lld", node->number);
+            break;
+        default:
+            printf("(");
+            printExprNode(system, node->left);
+            printf(node->op == EXPR_ADD ? " + " : node->op == EXPR_SUB ? " - " : " * ");
+            printExprNode(system, node->right);
+            printf(")");
+            break;
+    }
+}
+
+static void printExprValue(ExprValue value) {
+    char digits[48];
+    int length = 0;
+    unsigned __int128 magnitude = value < 0 ? -(unsigned __int128)value : (unsigned __int128)value;
+    do {
+        digits[length++] = (char)('0' + (int)(magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) {
+        printf("-");
+    }
+    while (length > 0) {
+        printf("%c", digits[--length]);
+    }
+}
+
+static void printSystemSolution(AlphameticSystem *system) {
+    static const char *relationText[] = {"=", "!=", "<", "<=", ">", ">="};
+    printf("\nSolution #%lld:\n", system->solutionCount);
+    for (int i = 0; i < system->numLetters; i++) {
+        printf("%c = %d\n", system->letters[i], system->assigned[i]);
+    }
+    for (int c = 0; c < system->numConstraints; c++) {
+        ExprConstraint *constraint = &system->constraints[c];
+        printExprNode(system, constraint->left);
+        printf(" %s ", relationText[constraint->relation]);
+        printExprNode(system, constraint->right);
+        printf("   (");
+        printExprValue(system->value[constraint->left]);
+        printf(" %s ", relationText[constraint->relation]);
+        printExprValue(system->value[constraint->right]);
+        printf(")\n");
+    }
+}
+
+// Assign letters in schedule order. After each assignment only the nodes whose
+// last letter was just assigned are evaluated, reusing the cached values of
+// their operands, and every constraint that became computable is checked.
+// Equations are also checked on their low digits as soon as those are known.
+bool solveSystem(AlphameticSystem *system, int depth) {
+    system->nodesVisited++;
+    
+    for (int i = system->modCheckStart[depth]; i < system->modCheckStart[depth + 1]; i++) {
+        ExprConstraint *constraint = &system->constraints[system->modCheckConstraint[i]];
+        long long modulus = 1;
+        for (int d = 0; d < system->modCheckDigits[i]; d++) {
+            modulus *= 10;
+        }
+        if (evaluateExprMod(system, constraint->left, modulus) != evaluateExprMod(system, constraint->right, modulus)) {
+            return false;
+        }
+    }
+    
+    for (int i = system->nodeStart[depth]; i < system->nodeStart[depth + 1]; i++) {
+        if (!evaluateExprNode(system, system->nodeOrder[i])) {
+            // Pruning here could drop true solutions, so give up instead
+            system->tooLarge = true;
+            return false;
+        }
+    }
+    for (int i = system->constraintStart[depth]; i < system->constraintStart[depth + 1]; i++) {
+        if (!constraintHolds(system, &system->constraints[system->constraintOrder[i]])) {
+            return false;
+        }
+    }
+    
+    if (depth == system->numLetters) {
+        system->solutionCount++;
+        if (system->verbose) {
+            printSystemSolution(system);
+        }
+        return true;
+    }
+    
+    bool foundAnySolution = false;
+    DigitMask choices = system->domain[depth];
+    while (choices && !system->tooLarge) {
+        int digit = minDigit(choices);
+        choices &= choices - 1;
+        if (system->used[digit]) {
+            continue;
+        }
+        system->assigned[depth] = digit;
+        system->used[digit] = true;
+        if (solveSystem(system, depth + 1)) {
+            foundAnySolution = true;
+        }
+        system->used[digit] = false;
+    }
+    return foundAnySolution;
+}
+
+// Solve a general alphametic system given on the command line
+int runExpression(const char *text) {
+    AlphameticSystem *system = malloc(sizeof(AlphameticSystem));
+    const char *error = NULL;
+    if (!parseAlphameticSystem(system, text, &error)) {
+        printf("Error parsing expression: %s\n", error);
+        free(system);
+        return 1;
+    }
+    
+    printf("System has %d constraints, %d expression nodes and %d unique characters: ",
+           system->numConstraints, system->numNodes, system->numLetters);
+    for (int i = 0; i < system->numLetters; i++) {
+        printf("%c ", system->letters[i]);
+    }
+    printf("\n");
+    
+    double start = nowSeconds();
+    solveSystem(system, 0);
+    double elapsed = nowSeconds() - start;
+    
+    if (system->tooLarge) {
+        printf("Error: A value exceeds %d bits, so the system cannot be checked.\n", (int)sizeof(ExprValue) * 8 - 1);
+        free(system);
+        return 1;
+    }
+    if (system->solutionCount > 0) {
+        printf("\nTotal solutions found: %lld\n", system->solutionCount);
+    } else {
+        printf("\nNo solution exists for this puzzle.\n");
+    }
+    printf("Nodes: %lld, search time: %.3f ms\n", system->nodesVisited, elapsed * 1000.0);
+    free(system);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Library interface (cryptarithmetic.h)
+// ---------------------------------------------------------------------------
+
+// Handler for --count and for library calls without a handler: solutions
+// are only counted by reportSolution
+static void countSolution(Puzzle *puzzle, void *context) {
+    (void)puzzle;
+    (void)context;
+}
+
+void defaultSolverOptions(SolverOptions *options) {
+    options->mode = SOLVER_LINEAR;
+    options->variableOrder = ORDER_APPEARANCE;
+    options->numThreads = 1;
+    options->maxSolutions = 0;
+    options->memoEntries = MEMO_ENTRIES;
+    options->countOnly = false;
+    options->cache = NULL;
+}
+
+Puzzle *createPuzzle(const char *text, int base, const char **error) {
+    const char *message = NULL;
+    Puzzle *puzzle = malloc(sizeof(Puzzle));
+    
+    initPuzzle(puzzle);
+    puzzle->base = base;
+    puzzle->verbose = false;
+    if (base < 2 || base > MAX_BASE) {
+        message = "base out of range";
+    } else if (!parsePuzzleString(puzzle, text, &message)) {
+        // message already set
+    } else if (!preparePuzzle(puzzle)) {
+        message = "too many unique letters";
+    }
+    if (message != NULL) {
+        if (error != NULL) {
+            *error = message;
+        }
+        free(puzzle);
+        return NULL;
+    }
+    return puzzle;
+}
+
+void destroyPuzzle(Puzzle *puzzle) {
+    free(puzzle);
+}
+
+// The search runs on a private copy, so 'puzzle' is never modified
+long long solvePuzzle(const Puzzle *puzzle, const SolverOptions *options, SolutionHandler onSolution,
+                      void *context, const atomic_bool *cancel, SolverStats *stats) {
+    if (options->mode < SOLVER_BACKTRACK || options->mode > SOLVER_MEET) {
+        return -1;
+    }
+    
+    Puzzle *work = malloc(sizeof(Puzzle));
+    memcpy(work, puzzle, sizeof(Puzzle));
+    work->verbose = false;
+    work->onSolution = onSolution != NULL ? onSolution : countSolution;
+    work->solutionContext = context;
+    work->cancel = cancel;
+    work->variableOrder = options->variableOrder;
+    work->maxSolutions = options->maxSolutions;
+    work->memoEntries = options->memoEntries;
+    work->countOnly = options->countOnly;
+    work->cache = options->cache;
+    work->dimacsPath = NULL;
+    work->kernelPath = NULL;
+    work->solutionCount = 0;
+    
+    runSolver(work, options->mode, options->numThreads);
+    
+    long long count = work->solutionCount;
+    if (stats != NULL) {
+        stats->nodes = work->nodes;
+        stats->backtracks = work->backtracks;
+        stats->prunes = work->prunes;
+        stats->stopped = work->stopped;
+        stats->cached = work->cacheHit;
+    }
+    free(work);
+    return count;
+}
+
+int puzzleLetterCount(const Puzzle *puzzle) {
+    return puzzle->numUniqueChars;
+}
+
+char puzzleLetter(const Puzzle *puzzle, int index) {
+    return puzzle->uniqueChars[index];
+}
+
+int puzzleDigit(const Puzzle *puzzle, int index) {
+    return puzzle->assigned[index];
+}
+
+#ifndef CRYPTARITHMETIC_LIBRARY
+
+// ---------------------------------------------------------------------------
+// One puzzle from the command line, without per-solution printf
+// ---------------------------------------------------------------------------
+
+// Buffered sink for --emit: solutions are written in large blocks
+typedef struct {
+    FILE *file;
+    bool binary;
+    size_t length;
+    char buffer[1 << 16];
+} SolutionWriter;
+
+static void flushWriter(SolutionWriter *writer) {
+    fwrite(writer->buffer, 1, writer->length, writer->file);
+    writer->length = 0;
+}
+
+static void writeBytes(SolutionWriter *writer, const void *data, size_t size) {
+    if (writer->length + size > sizeof(writer->buffer)) {
+        flushWriter(writer);
+    }
+    memcpy(writer->buffer + writer->length, data, size);
+    writer->length += size;
+}
+
+// CSV: a line with the letters. Binary: "ALPH", the letter count as one byte,
+// then the letters; every record after it is one digit byte per letter.
+static void writeHeader(SolutionWriter *writer, Puzzle *puzzle) {
+    int n = puzzle->numUniqueChars;
+    if (writer->binary) {
+        unsigned char count = n;
+        writeBytes(writer, "ALPH", 4);
+        writeBytes(writer, &count, 1);
+        writeBytes(writer, puzzle->uniqueChars, n);
+    } else {
+        for (int i = 0; i < n; i++) {
+            if (i > 0) {
+                writeBytes(writer, ",", 1);
+            }
+            writeBytes(writer, &puzzle->uniqueChars[i], 1);
+        }
+        writeBytes(writer, "\n", 1);
+    }
+}
+
+static void writeSolution(Puzzle *puzzle, void *context) {
+    SolutionWriter *writer = context;
+    int n = puzzle->numUniqueChars;
+    
+    if (writer->binary) {
+        unsigned char record[MAX_UNIQUE_CHARS];
+        for (int i = 0; i < n; i++) {
+            record[i] = puzzle->assigned[i];
+        }
+        writeBytes(writer, record, n);
+        return;
+    }
+    
+    // Digits are below 64, so at most two characters each
+    char line[MAX_UNIQUE_CHARS * 3 + 1];
+    int length = 0;
+    for (int i = 0; i < n; i++) {
+        int digit = puzzle->assigned[i];
+        if (i > 0) {
+            line[length++] = ',';
+        }
+        if (digit >= 10) {
+            line[length++] = '0' + digit / 10;
+        }
+        line[length++] = '0' + digit % 10;
+    }
+    line[length++] = '\n';
+    writeBytes(writer, line, length);
+}
+
+static const char *orderNames[] = {NULL, "appearance", "mrv", "column", "coefficient"};
+static const char *solverNames[] = {NULL, "backtrack", "columns", "propagation", "linear",
+                                    "parallel", "permutation", "sat", "kernel", "meet"};
+
+// Side-by-side runs instead of a single solve
+typedef enum {
+    COMPARE_NONE,
+    COMPARE_ORDERS,     // Every variable ordering of the propagation solver
+    COMPARE_SAT,        // The SAT backend against plain backtracking
+    COMPARE_MEET        // Meet in the middle against plain backtracking
+} CompareMode;
+
+// Count the solutions with each of 'modes' (and, for the propagation solver,
+// each of 'orders') and print the size, table memory and time of every search
+static void compareRuns(Puzzle *puzzle, const SolverMode *modes, const VariableOrder *orders, int count) {
+    printf("%-12s %-12s %10s %12s %12s %12s %10s %10s\n", "solver", "order", "solutions", "nodes",
+           "backtracks", "prunes", "table_kib", "time_ms");
+    puzzle->onSolution = countSolution;
+    puzzle->cache = NULL;
+    for (int k = 0; k < count; k++) {
+        puzzle->variableOrder = orders[k];
+        puzzle->solutionCount = 0;
+        double start = nowSeconds();
+        runSolver(puzzle, modes[k], 1);
+        double elapsed = nowSeconds() - start;
+        printf("%-12s %-12s %10lld %12lld %12lld %12lld %10.1f %10.3f\n", solverNames[modes[k]],
+               modes[k] == SOLVER_PROPAGATION ? orderNames[orders[k]] : "-", puzzle->solutionCount,
+               puzzle->nodes, puzzle->backtracks, puzzle->prunes, puzzle->tableBytes / 1024.0,
+               elapsed * 1000.0);
+    }
+}
+
+// Solve a puzzle given as "WORD+WORD=RESULT" with the options set on
+// 'settings' (base, limit, count-only, ordering, memo size, DIMACS path).
+// Solutions are printed as in interactive mode, only counted, or streamed
+// as CSV or binary records ('emitFormat') to 'outputPath' or stdout. Stats
+// go to stderr whenever records go to stdout.
+int runPuzzle(const char *text, const Puzzle *settings, SolverMode mode, int numThreads,
+              const char *emitFormat, const char *outputPath, CompareMode compare) {
+    Puzzle *puzzle = malloc(sizeof(Puzzle));
+    const char *error = NULL;
+    
+    memcpy(puzzle, settings, sizeof(Puzzle));
+    puzzle->verbose = false;
+    if (!parsePuzzleString(puzzle, text, &error)) {
+        printf("Error parsing puzzle: %s\n", error);
+        free(puzzle);
+        return 1;
+    }
+    if (!preparePuzzle(puzzle)) {
+        printf("Error: Too many unique characters. Maximum allowed in base %d is %d.\n",
+               puzzle->base, puzzle->base);
+        free(puzzle);
+        return 1;
+    }
+    if (compare == COMPARE_ORDERS) {
+        SolverMode modes[] = {SOLVER_PROPAGATION, SOLVER_PROPAGATION, SOLVER_PROPAGATION, SOLVER_PROPAGATION};
+        VariableOrder orders[] = {ORDER_APPEARANCE, ORDER_MRV, ORDER_COLUMN, ORDER_COEFFICIENT};
+        compareRuns(puzzle, modes, orders, 4);
+        free(puzzle);
+        return 0;
+    }
+    if (compare == COMPARE_SAT) {
+        SolverMode modes[] = {SOLVER_SAT, SOLVER_BACKTRACK};
+        VariableOrder orders[] = {puzzle->variableOrder, puzzle->variableOrder};
+        compareRuns(puzzle, modes, orders, 2);
+        free(puzzle);
+        return 0;
+    }
+    if (compare == COMPARE_MEET) {
+        SolverMode modes[] = {SOLVER_MEET, SOLVER_BACKTRACK};
+        VariableOrder orders[] = {puzzle->variableOrder, puzzle->variableOrder};
+        compareRuns(puzzle, modes, orders, 2);
+        free(puzzle);
+        return 0;
+    }
+    
+    SolutionWriter *writer = NULL;
+    FILE *stats = stdout;
+    if (emitFormat != NULL) {
+        FILE *output = (outputPath != NULL) ? fopen(outputPath, "wb") : stdout;
+        if (output == NULL) {
+            printf("Error opening %s.\n", outputPath);
+            free(puzzle);
+            return 1;
+        }
+        writer = malloc(sizeof(SolutionWriter));
+        writer->file = output;
+        writer->binary = strcmp(emitFormat, "binary") == 0;
+        writer->length = 0;
+        writeHeader(writer, puzzle);
+        puzzle->onSolution = writeSolution;
+        puzzle->solutionContext = writer;
+        if (output == stdout) {
+            stats = stderr;
+        }
+    } else if (puzzle->countOnly) {
+        puzzle->onSolution = countSolution;
+    }
+    
+    double start = nowSeconds();
+    runSolver(puzzle, mode, numThreads);
+    double elapsed = nowSeconds() - start;
+    
+    if (writer != NULL) {
+        flushWriter(writer);
+        if (writer->file != stdout) {
+            fclose(writer->file);
+        }
+        free(writer);
+    }
+    fprintf(stats, "Solutions: %lld%s%s, nodes: %lld, backtracks: %lld, prunes: %lld, memo hits: %lld, time: %.3f ms\n",
+            puzzle->solutionCount, puzzle->cacheHit ? " (cached)" : "", puzzle->stopped ? " (limit reached)" : "",
+            puzzle->nodes, puzzle->backtracks, puzzle->prunes, puzzle->memoHits, elapsed * 1000.0);
+    free(puzzle);
+    return 0;
+}
+
+// Run every puzzle of a corpus file through each solver (or only 'solver'
+// when it is non-zero) in count-only mode. Corpus lines are
+// "PUZZLE EXPECTED_COUNT [BASE]"; blank lines and '#' comments are skipped.
+// Prints nodes, nodes/sec, wall time and whether the count matched, then a
+// per-solver summary. The brute-force solvers are skipped above base 10.
+// Returns 1 if any run found the wrong count.
+int runBench(const char *corpusPath, const Puzzle *settings, int solver, int numThreads) {
+    FILE *input = fopen(corpusPath, "r");
+    if (input == NULL) {
+        printf("Error opening %s.\n", corpusPath);
+        return 1;
+    }
+    
+    Puzzle *prepared = malloc(sizeof(Puzzle));
+    Puzzle *puzzle = malloc(sizeof(Puzzle));
+    char line[MAX_WORDS * (MAX_LEN + 1) + 64];
+    char text[sizeof(line)];
+    int runs[SOLVER_MEET + 1] = {0}, failures[SOLVER_MEET + 1] = {0};
+    long long totalNodes[SOLVER_MEET + 1] = {0};
+    double totalTime[SOLVER_MEET + 1] = {0};
+    int lineNumber = 0;
+    int skipped = 0;
+    
+    printf("%-36s %-12s %10s %10s %-6s %12s %14s %10s\n", "puzzle", "solver", "expected", "found",
+           "status", "nodes", "nodes/sec", "time_ms");
+    while (fgets(line, sizeof(line), input) != NULL) {
+        long long expected;
+        int base = 10;
+        lineNumber++;
+        
+        char *start = line;
+        while (isspace((unsigned char)*start)) {
+            start++;
+        }
+        if (*start == '\0' || *start == '#') {
+            continue;
+        }
+        if (sscanf(start, "%s %lld %d", text, &expected, &base) < 2 || base < 2 || base > MAX_BASE) {
+            printf("Skipping malformed line %d of %s\n", lineNumber, corpusPath);
+            continue;
+        }
+        
+        const char *error = NULL;
+        memcpy(prepared, settings, sizeof(Puzzle));
+        prepared->base = base;
+        prepared->verbose = false;
+        prepared->countOnly = true;
+        prepared->maxSolutions = 0;
+        prepared->dimacsPath = NULL;
+        prepared->cache = NULL;
+        prepared->onSolution = countSolution;
+        if (!parsePuzzleString(prepared, text, &error) || !preparePuzzle(prepared)) {
+            printf("%-36.36s %-12s %10lld %10s %-6s\n", text, "-", expected, "-", "ERROR");
+            failures[0]++;
+            continue;
+        }
+        
+        for (int mode = SOLVER_BACKTRACK; mode <= SOLVER_MEET; mode++) {
+            if (solver != 0 && mode != solver) {
+                continue;
+            }
+            // The brute-force solvers are only practical up to base 10, even
+            // when asked for by --solver
+            if (base > 10 && (mode == SOLVER_BACKTRACK || mode == SOLVER_PERMUTATION)) {
+                printf("%-36.36s %-12s %10lld %10s %-6s\n", text, solverNames[mode], expected, "-", "SKIP");
+                skipped++;
+                continue;
+            }
+            memcpy(puzzle, prepared, sizeof(Puzzle));
+            double begin = nowSeconds();
+            runSolver(puzzle, (SolverMode)mode, numThreads);
+            double elapsed = nowSeconds() - begin;
+            bool correct = puzzle->solutionCount == expected;
+            
+            runs[mode]++;
+            failures[mode] += correct ? 0 : 1;
+            totalNodes[mode] += puzzle->nodes;
+            totalTime[mode] += elapsed;
+            printf("%-36.36s %-12s %10lld %10lld %-6s %12lld %14.0f %10.3f\n", text, solverNames[mode], expected,
+                   puzzle->solutionCount, correct ? "OK" : "FAIL", puzzle->nodes,
+                   elapsed > 0 ? puzzle->nodes / elapsed : 0.0, elapsed * 1000.0);
+        }
+    }
+    fclose(input);
+    free(prepared);
+    free(puzzle);
+    
+    int totalFailures = failures[0];
+    printf("\n%-12s %6s %6s %14s %14s %12s\n", "solver", "runs", "failed", "nodes", "nodes/sec", "time_ms");
+    for (int mode = SOLVER_BACKTRACK; mode <= SOLVER_MEET; mode++) {
+        if (runs[mode] == 0) {
+            continue;
+        }
+        totalFailures += failures[mode];
+        printf("%-12s %6d %6d %14lld %14.0f %12.3f\n", solverNames[mode], runs[mode], failures[mode],
+               totalNodes[mode], totalTime[mode] > 0 ? totalNodes[mode] / totalTime[mode] : 0.0,
+               totalTime[mode] * 1000.0);
+    }
+    if (failures[0] > 0) {
+        printf("%d corpus entries could not be parsed\n", failures[0]);
+    }
+    if (skipped > 0) {
+        printf("%d brute-force runs skipped above base 10\n", skipped);
+    }
+    return totalFailures > 0 ? 1 : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Generator: sums of dictionary words that have exactly one solution
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    char text[MAX_LEN];
+    int length;
+    DigitMask letters;      // One bit per distinct letter (letterSlot)
+} GeneratorWord;
+
+typedef struct {
+    GeneratorWord *words;   // Sorted by length, then text
+    int numWords;
+    int lengthStart[MAX_LEN + 1];   // Words of length L are [lengthStart[L], lengthStart[L + 1])
+    int numAddends;
+    int base;
+    FILE *output;
+    pthread_mutex_t outputLock;
+    atomic_int next;        // Next first addend to hand out
+    atomic_int finished;    // Workers done
+    atomic_llong candidates;
+    atomic_llong solved;    // Candidates that passed the letter and length filters
+    atomic_llong accepted;
+} Generator;
+
+// Bit of a letter in a 64-bit letter set: A-Z, a-z, 0-9, '_', '@'
+static int letterSlot(char c) {
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return 26 + c - 'a';
+    }
+    if (c >= '0' && c <= '9') {
+        return 52 + c - '0';
+    }
+    return c == '_' ? 62 : 63;
+}
+
+static int compareGeneratorWords(const void *a, const void *b) {
+    const GeneratorWord *x = a, *y = b;
+    if (x->length != y->length) {
+        return x->length - y->length;
+    }
+    return strcmp(x->text, y->text);
+}
+
+// Try every result word whose length fits the addends in 'tuple'. The
+// result is at most one column longer than the longest addend, and the
+// whole candidate may not have more letters than the base has digits.
+static void tryResults(Generator *gen, const int *tuple, DigitMask letters, int maxLength) {
+    int longest = maxLength + 1 < MAX_LEN - 1 ? maxLength + 1 : MAX_LEN - 1;
+    int first = gen->lengthStart[maxLength], last = gen->lengthStart[longest + 1];
+    char text[MAX_WORDS * (MAX_LEN + 1)];
+    SolverOptions options;
+    
+    atomic_fetch_add(&gen->candidates, last - first);
+    defaultSolverOptions(&options);
+    options.maxSolutions = 2; // A second solution rules the candidate out
+    
+    for (int r = first; r < last; r++) {
+        if (__builtin_popcountll(letters | gen->words[r].letters) > gen->base) {
+            continue;
+        }
+        int length = 0;
+        for (int k = 0; k < gen->numAddends; k++) {
+            length += sprintf(text + length, "%s%s", k > 0 ? "+" : "", gen->words[tuple[k]].text);
+        }
+        sprintf(text + length, "=%s", gen->words[r].text);
+        
+        atomic_fetch_add(&gen->solved, 1);
+        Puzzle *puzzle = createPuzzle(text, gen->base, NULL);
+        if (puzzle == NULL) {
+            continue;
+        }
+        if (solvePuzzle(puzzle, &options, NULL, NULL, NULL, NULL) == 1) {
+            atomic_fetch_add(&gen->accepted, 1);
+            pthread_mutex_lock(&gen->outputLock);
+            fprintf(gen->output, "%s\n", text);
+            fflush(gen->output);
+            pthread_mutex_unlock(&gen->outputLock);
+        }
+        destroyPuzzle(puzzle);
+    }
+}
+
+// Choose addends tuple[depth..] with non-decreasing word indexes, so every
+// multiset of addends is tried once
+static void extendAddends(Generator *gen, int *tuple, int depth, DigitMask letters, int maxLength) {
+    if (depth == gen->numAddends) {
+        tryResults(gen, tuple, letters, maxLength);
+        return;
+    }
+    for (int w = tuple[depth - 1]; w < gen->numWords; w++) {
+        DigitMask combined = letters | gen->words[w].letters;
+        if (__builtin_popcountll(combined) > gen->base) {
+            continue;
+        }
+        tuple[depth] = w;
+        extendAddends(gen, tuple, depth + 1, combined,
+                      gen->words[w].length > maxLength ? gen->words[w].length : maxLength);
+    }
+}
+
+static void *generatorWorker(void *arg) {
+    Generator *gen = arg;
+    int tuple[MAX_WORDS];
+    int w;
+    while ((w = atomic_fetch_add(&gen->next, 1)) < gen->numWords) {
+        tuple[0] = w;
+        extendAddends(gen, tuple, 1, gen->words[w].letters, gen->words[w].length);
+    }
+    atomic_fetch_add(&gen->finished, 1);
+    return NULL;
+}
+
+// Mine a word list (one word per line) for puzzles of 'numAddends' words
+// plus a result with exactly one solution, on 'numThreads' threads. Accepted
+// puzzles are streamed to 'outputPath' (stdout if NULL); progress and the
+// candidate rate go to stderr.
+int runGenerator(const char *wordListPath, const char *outputPath, int numAddends, int base, int numThreads) {
+    FILE *input = fopen(wordListPath, "r");
+    if (input == NULL) {
+        printf("Error opening %s.\n", wordListPath);
+        return 1;
+    }
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+    if (numThreads > MAX_THREADS) {
+        numThreads = MAX_THREADS;
+    }
+    
+    Generator *gen = calloc(1, sizeof(Generator));
+    int capacity = 0;
+    char line[4 * MAX_LEN];
+    while (fgets(line, sizeof(line), input) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        int length = strlen(line);
+        bool valid = length > 0 && length < MAX_LEN;
+        for (int i = 0; i < length && valid; i++) {
+            valid = isPuzzleLetter(base, line[i]);
+        }
+        if (!valid) {
+            continue;
+        }
+        if (gen->numWords == capacity) {
+            capacity = capacity > 0 ? capacity * 2 : 1024;
+            gen->words = realloc(gen->words, capacity * sizeof(GeneratorWord));
+        }
+        GeneratorWord *word = &gen->words[gen->numWords++];
+        word->length = length;
+        word->letters = 0;
+        for (int i = 0; i <= length; i++) {
+            word->text[i] = normalizeLetter(base, line[i]);
+            if (i < length) {
+                word->letters |= DIGIT_BIT(letterSlot(word->text[i]));
+            }
+        }
+    }
+    fclose(input);
+    
+    // Sort, drop duplicates and index the words by length
+    if (gen->numWords > 0) {
+        qsort(gen->words, gen->numWords, sizeof(GeneratorWord), compareGeneratorWords);
+        int unique = 1;
+        for (int i = 1; i < gen->numWords; i++) {
+            if (strcmp(gen->words[i].text, gen->words[unique - 1].text) != 0) {
+                gen->words[unique++] = gen->words[i];
+            }
+        }
+        gen->numWords = unique;
+    }
+    for (int length = 0, w = 0; length <= MAX_LEN; length++) {
+        while (w < gen->numWords && gen->words[w].length < length) {
+            w++;
+        }
+        gen->lengthStart[length] = w;
+    }
+    
+    gen->output = (outputPath != NULL) ? fopen(outputPath, "w") : stdout;
+    if (gen->output == NULL) {
+        printf("Error opening %s.\n", outputPath);
+        free(gen->words);
+        free(gen);
+        return 1;
+    }
+    gen->numAddends = numAddends;
+    gen->base = base;
+    pthread_mutex_init(&gen->outputLock, NULL);
+    atomic_init(&gen->next, 0);
+    atomic_init(&gen->finished, 0);
+    atomic_init(&gen->candidates, 0);
+    atomic_init(&gen->solved, 0);
+    atomic_init(&gen->accepted, 0);
+    
+    fprintf(stderr, "%d words, %d addends, base %d, %d threads\n", gen->numWords, numAddends, base, numThreads);
+    double start = nowSeconds();
+    pthread_t threads[MAX_THREADS];
+    for (int t = 0; t < numThreads; t++) {
+        pthread_create(&threads[t], NULL, generatorWorker, gen);
+    }
+    
+    // Report progress once a second until the workers are done
+    double lastReport = start;
+    while (atomic_load(&gen->finished) < numThreads) {
+        usleep(50000);
+        double now = nowSeconds();
+        if (now - lastReport >= 1.0) {
+            fprintf(stderr, "%lld candidates, %lld solved, %lld accepted (%.0f candidates/sec)\n",
+                    (long long)atomic_load(&gen->candidates), (long long)atomic_load(&gen->solved),
+                    (long long)atomic_load(&gen->accepted), atomic_load(&gen->candidates) / (now - start));
+            lastReport = now;
+        }
+    }
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    double elapsed = nowSeconds() - start;
+    fprintf(stderr, "Done: %lld candidates, %lld solved, %lld accepted in %.3f s (%.0f candidates/sec, %.0f solves/sec)\n",
+            (long long)atomic_load(&gen->candidates), (long long)atomic_load(&gen->solved),
+            (long long)atomic_load(&gen->accepted), elapsed,
+            elapsed > 0 ? atomic_load(&gen->candidates) / elapsed : 0.0,
+            elapsed > 0 ? atomic_load(&gen->solved) / elapsed : 0.0);
+    
+    if (gen->output != stdout) {
+        fclose(gen->output);
+    }
+    pthread_mutex_destroy(&gen->outputLock);
+    free(gen->words);
+    free(gen);
+    return 0;
+}
+
+static void printUsage(const char *program) {
+    printf("Usage: %s [--base N] [--count] [--limit N]   (interactive)\n", program);
+    printf("       %s --solve \"SEND+MORE=MONEY\" [--solver 1-9] [--threads N] [--base N]\n", program);
+    printf("          [--count] [--limit N] [--emit csv|binary] [--output FILE]\n");
+    printf("          [--order appearance|mrv|column|coefficient|all]   (solver 3)\n");
+    printf("          [--memo ENTRIES]   (column solver memo size, 0 disables)\n");
+    printf("          [--dimacs FILE] [--compare-sat]   (solver 7)\n");
+    printf("          [--kernel-source FILE]   (solver 8, keeps the generated C)\n");
+    printf("          [--compare-meet]   (solver 9 against solver 1, with table memory)\n");
+    printf("       %s --batch FILE [--output FILE] [--format json|csv] [--threads N] [--base N]\n", program);
+    printf("       --cache FILE with --solve, --batch or interactive use answers isomorphic puzzles\n");
+    printf("          from FILE and adds new solution sets to it\n");
+    printf("       %s --bench CORPUS [--solver 1-9] [--threads N] [--memo ENTRIES]\n", program);
+    printf("       %s --generate WORDLIST [--addends N] [--output FILE] [--threads N] [--base N]\n", program);
+    printf("       %s --expr \"AB*C=DEF; DEF-AB=GHI; A<C\"\n", program);
+}
+
+int main(int argc, char *argv[]) {
+    Puzzle puzzle;
+    
+    // Options from the command line are kept on the puzzle
+    initPuzzle(&puzzle);
+    
+    if (argc > 1) {
+        const char *batchPath = NULL, *benchPath = NULL, *cachePath = NULL, *wordListPath = NULL, *outputPath = NULL, *format = "json";
+        const char *puzzleText = NULL, *emitFormat = NULL;
+        int solver = 0;
+        int numAddends = 2;
+        CompareMode compare = COMPARE_NONE;
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        int numThreads = cores > 0 ? (int)cores : 1;
+        
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+                batchPath = argv[++i];
+            } else if (strcmp(argv[i], "--generate") == 0 && i + 1 < argc) {
+                wordListPath = argv[++i];
+            } else if (strcmp(argv[i], "--addends") == 0 && i + 1 < argc) {
+                numAddends = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+                benchPath = argv[++i];
+            } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+                cachePath = argv[++i];
+            } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+                outputPath = argv[++i];
+            } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+                format = argv[++i];
+            } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+                numThreads = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--expr") == 0 && i + 1 < argc) {
+                return runExpression(argv[++i]);
+            } else if (strcmp(argv[i], "--base") == 0 && i + 1 < argc) {
+                puzzle.base = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--solve") == 0 && i + 1 < argc) {
+                puzzleText = argv[++i];
+            } else if (strcmp(argv[i], "--solver") == 0 && i + 1 < argc) {
+                solver = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--count") == 0) {
+                puzzle.countOnly = true;
+            } else if (strcmp(argv[i], "--limit") == 0 && i + 1 < argc) {
+                puzzle.maxSolutions = atol(argv[++i]);
+            } else if (strcmp(argv[i], "--emit") == 0 && i + 1 < argc) {
+                emitFormat = argv[++i];
+            } else if (strcmp(argv[i], "--memo") == 0 && i + 1 < argc) {
+                puzzle.memoEntries = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--dimacs") == 0 && i + 1 < argc) {
+                puzzle.dimacsPath = argv[++i];
+            } else if (strcmp(argv[i], "--kernel-source") == 0 && i + 1 < argc) {
+                puzzle.kernelPath = argv[++i];
+            } else if (strcmp(argv[i], "--compare-sat") == 0) {
+                compare = COMPARE_SAT;
+            } else if (strcmp(argv[i], "--compare-meet") == 0) {
+                compare = COMPARE_MEET;
+            } else if (strcmp(argv[i], "--order") == 0 && i + 1 < argc) {
+                const char *name = argv[++i];
+                int variableOrder = -1;
+                for (int order = ORDER_APPEARANCE; order <= ORDER_COEFFICIENT; order++) {
+                    if (strcmp(name, orderNames[order]) == 0) {
+                        variableOrder = order;
+                    }
+                }
+                if (strcmp(name, "all") == 0) {
+                    compare = COMPARE_ORDERS;
+                } else if (variableOrder < 0) {
+                    printUsage(argv[0]);
+                    return 1;
+                } else {
+                    puzzle.variableOrder = variableOrder;
+                }
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        if (puzzle.base < 2 || puzzle.base > MAX_BASE) {
+            printf("Invalid base. Must be between 2 and %d.\n", MAX_BASE);
+            return 1;
+        }
+        if (puzzle.kernelPath != NULL && strchr(puzzle.kernelPath, '\'') != NULL) {
+            printf("Invalid kernel source path. It may not contain a single quote.\n");
+            return 1;
+        }
+        if (cachePath != NULL) {
+            puzzle.cache = openSolutionCache(cachePath);
+            if (puzzle.cache == NULL) {
+                printf("Error opening %s.\n", cachePath);
+                return 1;
+            }
+        }
+        if (batchPath != NULL) {
+            if (strcmp(format, "json") != 0 && strcmp(format, "csv") != 0) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            int status = runBatch(batchPath, outputPath, format, numThreads, puzzle.base, puzzle.cache);
+            if (puzzle.cache != NULL) {
+                closeSolutionCache(puzzle.cache);
+            }
+            return status;
+        }
+        if (wordListPath != NULL) {
+            if (numAddends < 2 || numAddends > MAX_WORDS - 1) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            return runGenerator(wordListPath, outputPath, numAddends, puzzle.base, numThreads);
+        }
+        if (benchPath != NULL) {
+            if (solver < 0 || solver > SOLVER_MEET) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            return runBench(benchPath, &puzzle, solver, numThreads);
+        }
+        if (puzzleText != NULL) {
+            if (solver == 0) {
+                solver = SOLVER_LINEAR;
+            }
+            if (solver < SOLVER_BACKTRACK || solver > SOLVER_MEET ||
+                (emitFormat != NULL && strcmp(emitFormat, "csv") != 0 && strcmp(emitFormat, "binary") != 0)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            int status = runPuzzle(puzzleText, &puzzle, (SolverMode)solver, numThreads, emitFormat, outputPath, compare);
+            if (puzzle.cache != NULL) {
+                closeSolutionCache(puzzle.cache);
+            }
+            return status;
+        }
+    }
+    
+    if (puzzle.countOnly) {
+        puzzle.onSolution = countSolution;
+    }
+    
+    // Get number of words from the user
+    printf("Enter the number of words in the equation (max %d): ", MAX_WORDS - 1);
+    scanf("%d", &puzzle.numWords);
+    
+    if (puzzle.numWords < 1 || puzzle.numWords >= MAX_WORDS) {
+        printf("Invalid number of words. Must be between 1 and %d.\n", MAX_WORDS - 1);
+        return 1;
+    }
+    
+    // Get input words from the user
+    for (int i = 0; i < puzzle.numWords; i++) {
+        printf("Enter word %d: ", i + 1);
+        scanf("%s", puzzle.words[i]);
+        
+        // Convert to uppercase (bases above 26 are case-sensitive)
+        for (int j = 0; puzzle.words[i][j]; j++) {
+            puzzle.words[i][j] = normalizeLetter(puzzle.base, puzzle.words[i][j]);
+        }
+    }
+    
+    // Get the result word
+    printf("Enter the result word: ");
+    scanf("%s", puzzle.result);
+    
+    // Convert to uppercase
+    for (int i = 0; puzzle.result[i]; i++) {
+        puzzle.result[i] = normalizeLetter(puzzle.base, puzzle.result[i]);
+    }
+    
+    // Find unique characters and check if the problem is solvable
+    if (!findUniqueChars(&puzzle)) {
+        printf("Error: Too many unique characters. Maximum allowed in base %d is %d.\n", puzzle.base, puzzle.base);
+        return 1;
+    }
+    
+    printf("Puzzle has %d unique characters: ", puzzle.numUniqueChars);
+    for (int i = 0; i < puzzle.numUniqueChars; i++) {
+        printf("%c ", puzzle.uniqueChars[i]);
+    }
+    printf("\n");
+    
+    // Pre-compute constraints before backtracking
+    printf("\nAnalyzing constraints...\n");
+    preComputeConstraints(&puzzle);
+    printConstraintAnalysis(&puzzle);
+    
+    // Choose the search strategy
+    int mode;
+    printf("Select solver:\n");
+    printf("%d. Backtracking over all letters\n", SOLVER_BACKTRACK);
+    printf("%d. Column-wise with carry propagation\n", SOLVER_COLUMNS);
+    printf("%d. Bitmask domains with constraint propagation\n", SOLVER_PROPAGATION);
+    printf("%d. Compiled linear equation with partial-sum bounds\n", SOLVER_LINEAR);
+    printf("%d. Parallel linear search (work-stealing)\n", SOLVER_PARALLEL);
+    printf("%d. Permutation brute force with SIMD lanes (small puzzles)\n", SOLVER_PERMUTATION);
+    printf("%d. CNF encoding with the CDCL SAT solver\n", SOLVER_SAT);
+    printf("%d. Specialised C kernel compiled for this puzzle\n", SOLVER_KERNEL);
+    printf("%d. Meet in the middle with a hash join on partial sums\n", SOLVER_MEET);
+    printf("Enter your choice: ");
+    if (scanf("%d", &mode) != 1) {
+        mode = SOLVER_COLUMNS;
+    }
+    
+    if (mode == SOLVER_PROPAGATION) {
+        printf("Variable ordering:\n");
+        printf("%d. Order of appearance\n", ORDER_APPEARANCE);
+        printf("%d. Smallest remaining domain (MRV)\n", ORDER_MRV);
+        printf("%d. Rightmost column first\n", ORDER_COLUMN);
+        printf("%d. Largest coefficient first\n", ORDER_COEFFICIENT);
+        printf("Enter your choice: ");
+        int order;
+        if (scanf("%d", &order) == 1 && order >= ORDER_APPEARANCE && order <= ORDER_COEFFICIENT) {
+            puzzle.variableOrder = order;
+        }
+    }
+    
+    int numThreads = 1;
+    if (mode == SOLVER_PARALLEL) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        printf("Number of threads (1-%d, detected %ld cores): ", MAX_THREADS, cores);
+        if (scanf("%d", &numThreads) != 1) {
+            numThreads = cores > 0 ? (int)cores : 1;
+        }
+    }
+    
+    double startTime = nowSeconds();
+    runSolver(&puzzle, (SolverMode)mode, numThreads);
+    double elapsed = nowSeconds() - startTime;
+    
+    if (puzzle.solutionCount > 0) {
+        printf("\nTotal solutions found: %lld\n", puzzle.solutionCount);
+    } else {
+        printf("\nNo solution exists for this puzzle.\n");
+    }
+    printf("Search time: %.3f ms (%lld nodes, %lld backtracks, %lld prunes)%s\n", elapsed * 1000.0,
+           puzzle.nodes, puzzle.backtracks, puzzle.prunes, puzzle.cacheHit ? ", answered from the cache" : "");
+    
+    if (puzzle.cache != NULL) {
+        closeSolutionCache(puzzle.cache);
+    }
+    return 0;
+}
+
+#endif // CRYPTARITHMETIC_LIBRARY
\ No newline at end of file
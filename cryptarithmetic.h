@@ -0,0 +1,91 @@
+// Reentrant interface to the alphametic solvers of cryptarithmetic.c.
+// Build without the command-line program:
+//   gcc -O2 -march=native -pthread -DCRYPTARITHMETIC_LIBRARY -c cryptarithmetic.c
+//
+//   const char *error;
+//   Puzzle *puzzle = createPuzzle("SEND+MORE=MONEY", 10, &error);
+//   SolverOptions options;
+//   defaultSolverOptions(&options);
+//   long long count = solvePuzzle(puzzle, &options, onSolution, context, &cancel, NULL);
+//   destroyPuzzle(puzzle);
+//
+// The solvers do no I/O and keep no global state, except SOLVER_KERNEL,
+// which writes to /tmp and runs the system compiler. Every solvePuzzle call
+// works on its own copy of the puzzle, so calls may run concurrently.
+#ifndef CRYPTARITHMETIC_H
+#define CRYPTARITHMETIC_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+typedef struct Puzzle Puzzle;
+typedef struct SolutionCache SolutionCache;
+
+// Available search strategies
+typedef enum {
+    SOLVER_BACKTRACK = 1,   // Assign every letter, check the sum at the leaf
+    SOLVER_COLUMNS,         // Column by column with carry, prune per column
+    SOLVER_PROPAGATION,     // Bitmask domains, propagation after every assignment
+    SOLVER_LINEAR,          // Compiled linear equation with partial-sum bounds
+    SOLVER_PARALLEL,        // Linear solver split into tasks on a work-stealing pool
+    SOLVER_PERMUTATION,     // Heap's-algorithm brute force with SIMD lanes
+    SOLVER_SAT,             // CNF encoding solved by the built-in CDCL solver
+    SOLVER_KERNEL,          // Puzzle compiled to specialised C at run time (cc + dlopen)
+    SOLVER_MEET             // Two halves of the letters joined on their partial sums
+} SolverMode;
+
+// Which letter the propagation solver branches on next
+typedef enum {
+    ORDER_APPEARANCE = 1,   // First unassigned letter in uniqueChars order
+    ORDER_MRV,              // Smallest remaining domain
+    ORDER_COLUMN,           // Letters of the rightmost columns first
+    ORDER_COEFFICIENT       // Largest |coefficient| in the whole equation first
+} VariableOrder;
+
+// Called by reportSolution for every solution; prints it when not set.
+// Library callers read the solution with puzzleLetter and puzzleDigit.
+typedef void (*SolutionHandler)(Puzzle *puzzle, void *context);
+
+typedef struct {
+    SolverMode mode;
+    VariableOrder variableOrder;    // Propagation solver only
+    int numThreads;                 // Parallel solver only
+    long maxSolutions;              // Stop after this many solutions (0 = find all)
+    int memoEntries;                // Column solver memo size, 0 disables it
+    bool countOnly;                 // Only the count matters: memoised subtrees skip the handler
+    SolutionCache *cache;           // Shared by any number of calls and threads, or NULL
+} SolverOptions;
+
+typedef struct {
+    long long nodes;
+    long long backtracks;
+    long long prunes;
+    bool stopped;                   // maxSolutions reached or cancelled
+    bool cached;                    // Answered from the solution cache
+} SolverStats;
+
+// Options as used by the command line: linear solver, one thread, all solutions
+void defaultSolverOptions(SolverOptions *options);
+
+// Parse "WORD+WORD=RESULT" in 'base' and run the pre-analysis. Returns NULL
+// and sets *error (when 'error' is not NULL) if the puzzle is invalid.
+Puzzle *createPuzzle(const char *text, int base, const char **error);
+void destroyPuzzle(Puzzle *puzzle);
+
+// Call onSolution (may be NULL) for every solution and return their number,
+// or -1 for an unknown mode. The search stops early once *cancel becomes
+// true. Statistics go to 'stats' when it is not NULL.
+long long solvePuzzle(const Puzzle *puzzle, const SolverOptions *options, SolutionHandler onSolution,
+                      void *context, const atomic_bool *cancel, SolverStats *stats);
+
+// Letters in order of first appearance, and their digits in the solution
+// being reported
+int puzzleLetterCount(const Puzzle *puzzle);
+char puzzleLetter(const Puzzle *puzzle, int index);
+int puzzleDigit(const Puzzle *puzzle, int index);
+
+// Solution sets of isomorphic puzzles, kept in a file (see --cache)
+SolutionCache *openSolutionCache(const char *path);
+void closeSolutionCache(SolutionCache *cache);
+
+#endif